@@ -0,0 +1,406 @@
+//
+// benchmark.cpp
+// ȵ·ܻ׼ Google Benchmark
+//  JSON --benchmark_out=result.json --benchmark_out_format=json
+// ͬ汾Ľ Google Benchmark Դ tools/compare.py Ա
+//
+
+#include "../JFramework.h"
+#include <atomic>
+#include <benchmark/benchmark.h>
+#include <cstdlib>
+#include <new>
+#include <utility>
+
+using namespace JFramework;
+
+// ͳƵǰ̵߳Ķѷÿεķʹ
+// ļɻ׼滻ȫ operator new ֻӰ׼
+static thread_local uint64_t gAllocationCount = 0;
+
+void* operator new(std::size_t size)
+{
+	++gAllocationCount;
+	if (void* p = std::malloc(size ? size : 1))
+		return p;
+	throw std::bad_alloc();
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+namespace
+{
+	// ޣӦ·ɵ
+	constexpr size_t MaxComponents = 256;
+
+	class BenchEvent : public IEvent
+	{
+	};
+
+	class CountingHandler : public ICanHandleEvent
+	{
+	public:
+		void HandleEvent(std::shared_ptr<IEvent> /*event*/) override { count.fetch_add(1, std::memory_order_relaxed); }
+		std::atomic<size_t> count { 0 };
+	};
+
+	template <size_t _Index>
+	class BenchUtility : public IUtility
+	{
+	};
+
+	template <size_t _Index>
+	class BenchModel : public AbstractModel
+	{
+	public:
+		int value = 0;
+
+	protected:
+		void OnInit() override {}
+		void OnDeinit() override {}
+	};
+
+	class CounterModel : public AbstractModel
+	{
+	public:
+		std::atomic<int> value { 0 };
+
+	protected:
+		void OnInit() override {}
+		void OnDeinit() override {}
+	};
+
+	class IncrementCommand : public AbstractCommand
+	{
+	protected:
+		void OnExecute() override { GetModel<CounterModel>()->value.fetch_add(1, std::memory_order_relaxed); }
+	};
+
+	class ReadCounterQuery : public AbstractQuery<int>
+	{
+	protected:
+		int OnDo() override { return GetModel<CounterModel>()->value.load(std::memory_order_relaxed); }
+	};
+
+	template <size_t... _Index>
+	void RegisterUtilities(IOCContainer& container, size_t count, std::index_sequence<_Index...>)
+	{
+		((_Index < count ? container.Register<IUtility>(typeid(BenchUtility<_Index>),
+							   std::shared_ptr<IUtility>(std::make_shared<BenchUtility<_Index>>()))
+						 : void()),
+			...);
+	}
+
+	template <size_t... _Index>
+	void RegisterModels(IArchitecture& architecture, size_t count, std::index_sequence<_Index...>)
+	{
+		((_Index < count ? architecture.RegisterModel(std::make_shared<BenchModel<_Index>>()) : void()), ...);
+	}
+
+	/// @brief עָ ModelCounterModel ʼմ
+	class BenchArchitecture : public Architecture
+	{
+	public:
+		explicit BenchArchitecture(size_t modelCount)
+			: mModelCount(modelCount)
+		{
+		}
+
+	protected:
+		void Init() override
+		{
+			RegisterModel(std::make_shared<CounterModel>());
+			RegisterModels(*this, mModelCount, std::make_index_sequence<MaxComponents>());
+		}
+
+	private:
+		size_t mModelCount;
+	};
+
+	/// @brief ͨ ICanGetModel  Model Ŀڵĵ͵
+	/// 󶨾ʱܹעһͨӵоʼܹʹ GetModelRef
+	class BenchController : public AbstractController
+	{
+	public:
+		explicit BenchController(std::shared_ptr<IArchitecture> architecture, bool bindHandle = false)
+			: mArchitecture(architecture)
+			, mHandle(bindHandle ? architecture.get() : nullptr)
+		{
+		}
+
+		std::weak_ptr<IArchitecture> GetArchitecture() const override { return mArchitecture; }
+		IArchitecture* GetArchitectureHandle() const override { return mHandle; }
+
+		int ReadModel()
+		{
+			if (mHandle)
+				return GetModelRef<BenchModel<0>>().value;
+			return GetModel<BenchModel<0>>()->value;
+		}
+
+	protected:
+		void OnEvent(std::shared_ptr<IEvent> /*event*/) override {}
+
+	private:
+		std::weak_ptr<IArchitecture> mArchitecture;
+		IArchitecture* mHandle;
+	};
+
+	/// @brief  allocs_per_iter ʱѭÿεƽѷ
+	/// ̻߳׼ÿ̸߳ͳƣܺȫ
+	class AllocationCounter
+	{
+	public:
+		explicit AllocationCounter(benchmark::State& state)
+			: mState(state)
+			, mBegin(gAllocationCount)
+		{
+		}
+
+		~AllocationCounter()
+		{
+			mState.counters["allocs_per_iter"] = benchmark::Counter(
+				static_cast<double>(gAllocationCount - mBegin), benchmark::Counter::kAvgIterations);
+		}
+
+	private:
+		benchmark::State& mState;
+		uint64_t mBegin;
+	};
+
+	std::shared_ptr<BenchArchitecture> MakeArchitecture(size_t modelCount)
+	{
+		auto architecture = std::make_shared<BenchArchitecture>(modelCount);
+		architecture->InitArchitecture();
+		return architecture;
+	}
+
+	// ̻߳׼Ķ߳ǰ
+	std::shared_ptr<EventBus> gSharedBus;
+	std::vector<CountingHandler> gSharedHandlers(8);
+	std::shared_ptr<IOCContainer> gSharedContainer;
+	std::shared_ptr<BenchArchitecture> gSharedArchitecture;
+
+	void SetUpSharedBus(const benchmark::State&)
+	{
+		gSharedBus = std::make_shared<EventBus>();
+		for (auto& handler : gSharedHandlers)
+			gSharedBus->RegisterEvent(typeid(BenchEvent), &handler);
+	}
+
+	void TearDownSharedBus(const benchmark::State&) { gSharedBus.reset(); }
+
+	void SetUpSharedContainer(const benchmark::State&)
+	{
+		gSharedContainer = std::make_shared<IOCContainer>();
+		RegisterUtilities(*gSharedContainer, 16, std::make_index_sequence<MaxComponents>());
+	}
+
+	void TearDownSharedContainer(const benchmark::State&) { gSharedContainer.reset(); }
+
+	// Ի׼Ϊ Model 
+	void SetUpSharedArchitecture(const benchmark::State& state)
+	{
+		gSharedArchitecture = MakeArchitecture(static_cast<size_t>(state.range(0)));
+	}
+
+	void TearDownSharedArchitecture(const benchmark::State&) { gSharedArchitecture.reset(); }
+}
+
+// ================ EventBus ================
+
+static void BM_EventBusSendEvent(benchmark::State& state)
+{
+	EventBus bus;
+	std::vector<CountingHandler> handlers(static_cast<size_t>(state.range(0)));
+	for (auto& handler : handlers)
+		bus.RegisterEvent(typeid(BenchEvent), &handler);
+	auto event = std::make_shared<BenchEvent>();
+
+	for (auto _ : state)
+	{
+		bus.SendEvent(event);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_EventBusSendEvent)->ArgName("handlers")->Arg(1)->Arg(8)->Arg(64)->Arg(512);
+
+static void BM_EventBusSendEventThreaded(benchmark::State& state)
+{
+	auto event = std::make_shared<BenchEvent>();
+
+	for (auto _ : state)
+	{
+		gSharedBus->SendEvent(event);
+	}
+}
+BENCHMARK(BM_EventBusSendEventThreaded)
+	->Setup(SetUpSharedBus)
+	->Teardown(TearDownSharedBus)
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+static void BM_EventBusRegisterUnRegister(benchmark::State& state)
+{
+	EventBus bus;
+	std::vector<CountingHandler> existing(static_cast<size_t>(state.range(0)));
+	for (auto& handler : existing)
+		bus.RegisterEvent(typeid(BenchEvent), &handler);
+	CountingHandler handler;
+
+	for (auto _ : state)
+	{
+		bus.RegisterEvent(typeid(BenchEvent), &handler);
+		bus.UnRegisterEvent(typeid(BenchEvent), &handler);
+	}
+}
+BENCHMARK(BM_EventBusRegisterUnRegister)->ArgName("handlers")->Arg(0)->Arg(8)->Arg(64)->Arg(512);
+
+// ================ IOCContainer ================
+
+static void BM_IOCContainerGet(benchmark::State& state)
+{
+	IOCContainer container;
+	RegisterUtilities(container, static_cast<size_t>(state.range(0)), std::make_index_sequence<MaxComponents>());
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(container.Get<IUtility>(typeid(BenchUtility<0>)));
+	}
+}
+BENCHMARK(BM_IOCContainerGet)->ArgName("components")->Arg(1)->Arg(16)->Arg(MaxComponents);
+
+static void BM_IOCContainerGetThreaded(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(gSharedContainer->Get<IUtility>(typeid(BenchUtility<0>)));
+	}
+}
+BENCHMARK(BM_IOCContainerGetThreaded)
+	->Setup(SetUpSharedContainer)
+	->Teardown(TearDownSharedContainer)
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+// ================ ICanGetModel ================
+
+// ref=0 Ϊ weak_ptr  GetModelref=1 Ϊ GetModelRef
+static void BM_GetModel(benchmark::State& state)
+{
+	auto architecture = MakeArchitecture(static_cast<size_t>(state.range(0)));
+	BenchController controller(architecture, state.range(1) != 0);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(controller.ReadModel());
+	}
+}
+BENCHMARK(BM_GetModel)->ArgNames({ "models", "ref" })->ArgsProduct({ { 1, 16, MaxComponents }, { 0, 1 } });
+
+static void BM_GetModelThreaded(benchmark::State& state)
+{
+	BenchController controller(gSharedArchitecture, state.range(1) != 0);
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(controller.ReadModel());
+	}
+}
+BENCHMARK(BM_GetModelThreaded)
+	->ArgNames({ "models", "ref" })
+	->ArgsProduct({ { 1, MaxComponents }, { 0, 1 } })
+	->Setup(SetUpSharedArchitecture)
+	->Teardown(TearDownSharedArchitecture)
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+// ================ BindableProperty ================
+
+static void BM_BindablePropertySetValue(benchmark::State& state)
+{
+	BindableProperty<int> property(0);
+	if (state.range(1))
+		property.EnableJournal(1024);
+	size_t notified = 0;
+	std::vector<std::shared_ptr<BindablePropertyUnRegister<int>>> observers;
+	for (int64_t i = 0; i < state.range(0); ++i)
+		observers.push_back(property.Register([&](const int&) { ++notified; }));
+
+	int value = 0;
+	for (auto _ : state)
+	{
+		property.SetValue(++value);
+	}
+	benchmark::DoNotOptimize(notified);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_BindablePropertySetValue)
+	->ArgNames({ "observers", "journal" })
+	->ArgsProduct({ { 0, 1, 8, 64 }, { 0, 1 } });
+
+// ================ ѯ ================
+
+static void BM_SendCommand(benchmark::State& state)
+{
+	auto architecture = MakeArchitecture(static_cast<size_t>(state.range(0)));
+
+	for (auto _ : state)
+	{
+		architecture->SendCommand<IncrementCommand>();
+	}
+}
+BENCHMARK(BM_SendCommand)->ArgName("models")->Arg(0)->Arg(MaxComponents);
+
+static void BM_SendCommandThreaded(benchmark::State& state)
+{
+	for (auto _ : state)
+	{
+		gSharedArchitecture->SendCommand<IncrementCommand>();
+	}
+}
+BENCHMARK(BM_SendCommandThreaded)
+	->ArgName("models")
+	->Arg(MaxComponents)
+	->Setup(SetUpSharedArchitecture)
+	->Teardown(TearDownSharedArchitecture)
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+static void BM_SendQuery(benchmark::State& state)
+{
+	auto architecture = MakeArchitecture(static_cast<size_t>(state.range(0)));
+
+	AllocationCounter allocations(state);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(architecture->SendQuery<ReadCounterQuery>());
+	}
+}
+BENCHMARK(BM_SendQuery)->ArgName("models")->Arg(0)->Arg(MaxComponents);
+
+static void BM_SendQueryThreaded(benchmark::State& state)
+{
+	AllocationCounter allocations(state);
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(gSharedArchitecture->SendQuery<ReadCounterQuery>());
+	}
+}
+BENCHMARK(BM_SendQueryThreaded)
+	->ArgName("models")
+	->Arg(MaxComponents)
+	->Setup(SetUpSharedArchitecture)
+	->Teardown(TearDownSharedArchitecture)
+	->ThreadRange(1, 8)
+	->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -25,16 +25,67 @@
 #ifndef JFRAMEWORK
 #define JFRAMEWORK
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
 #include <exception>
 #include <functional>
+#include <future>
 #include <iostream> // For default logger
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <queue>
+#include <shared_mutex>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
 #include <typeindex>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
 #include <vector>
 
+// ֧ C++20 ЭʱЭ/ѯ
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define JFRAMEWORK_HAS_COROUTINES 1
+#else
+#define JFRAMEWORK_HAS_COROUTINES 0
+#endif
+
+// Ϊ 1 ʱѯ¼֪ͨ׷ٵ㣬ʱ Tracer::SetEnabled 
+// δΪ 0 ʱ׷ٺչΪ
+#ifndef JFRAMEWORK_ENABLE_TRACING
+#define JFRAMEWORK_ENABLE_TRACING 0
+#endif
+
+// Ϊ 1 ʱͳ򣬰ܲͳƶѷ䣬 AllocationTracker
+#ifndef JFRAMEWORK_ENABLE_ALLOCATION_TRACKING
+#define JFRAMEWORK_ENABLE_ALLOCATION_TRACKING 0
+#endif
+
+// Ϊ 1 ʱڲȵ㻥 ProfiledMutexͳƸλõľ LockProfiler
+#ifndef JFRAMEWORK_ENABLE_LOCK_PROFILING
+#define JFRAMEWORK_ENABLE_LOCK_PROFILING 0
+#endif
+
+#define JFRAMEWORK_CONCAT_IMPL(a, b) a##b
+#define JFRAMEWORK_CONCAT(a, b) JFRAMEWORK_CONCAT_IMPL(a, b)
+
+// ׷ָлԭ GCC/Clang 
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#endif
+
 namespace JFramework
 {
 	// ================ 쳣 ================
@@ -80,7 +131,26 @@ namespace JFramework
 		}
 	};
 
+	class CommandJournalException : public FrameworkException
+	{
+	public:
+		explicit CommandJournalException(const std::string& message)
+			: FrameworkException("Command journal error: " + message)
+		{
+		}
+	};
+
+	class ModelAccessException : public FrameworkException
+	{
+	public:
+		explicit ModelAccessException(const std::string& message)
+			: FrameworkException("Model access error: " + message)
+		{
+		}
+	};
+
 	// ================ ǰ ================
+	class IArchitecture;
 	class ISystem;
 	class IModel;
 	class IJCommand;
@@ -90,765 +160,5775 @@ namespace JFramework
 	template <typename _Ty>
 	class BindableProperty;
 	class IOCContainer;
+	class QueryCache;
+	class CommandHistory;
+	class ModelAccess;
+	class TimerService;
+	class TimerToken;
+	class ModelAccessGuard;
+	class MetricsRegistry;
+#if JFRAMEWORK_HAS_COROUTINES
+	class CoroutineScheduler;
+	class ICoroutineCommand;
+	template <typename _Ty>
+	class Task;
+#endif
 
-	/// @brief ¼ӿ
-	class IEvent
+	// ¼/ѯִڼ Model ʣ ModelAccessTracker
+	inline void TrackModelAccess(const std::shared_ptr<IModel>& model);
+	// ͨӵ÷ʱļ¼ɳ¼ڼҪ shared_ptr false ɵ÷һ
+	inline bool TrackModelAccess(IModel* model);
+	inline void IncrementModelVersion(IModel* model);
+
+	// ǰ߳Ƿ Model д ModelAccessGuard
+	inline bool IsHoldingModelAccess();
+
+	// ѯ Model ʻȡдִвѯģʵ
+	template <typename _Query>
+	auto DoGuardedQuery(IArchitecture& architecture, _Query& query) -> decltype(query.Do());
+
+	// ================ ׷ ================
+
+	// typeid().name() ĿɶʽGCC/Clang »ԭ׷ָ
+	inline std::string DemangleTypeName(const char* name)
 	{
-	public:
-		virtual ~IEvent() = default;
-	};
+#if defined(__GNUG__)
+		int status = 0;
+		char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+		if (status == 0 && demangled)
+		{
+			std::string result(demangled);
+			std::free(demangled);
+			return result;
+		}
+#endif
+		return name;
+	}
 
-	/// @brief Event
-	class ICanHandleEvent
+	/// @brief һ׷ټ¼Ϊ̬洢ַ typeid().name()
+	struct TraceEvent
 	{
-	public:
-		virtual ~ICanHandleEvent() = default;
-		virtual void HandleEvent(std::shared_ptr<IEvent> event) = 0;
+		const char* category;
+		const char* name;
+		uint64_t start;    // ׷
+		uint64_t duration; // 
 	};
 
-	/// @brief ¼ʵ
-	class EventBus
+	/// @brief ׷
+	/// ÿ߳дԼĻ¼ʱ䣬д¼¼
+	/// Ϊ Chrome trace JSON chrome://tracing  Perfetto 
+	class Tracer
 	{
 	public:
-		void RegisterEvent(std::type_index eventType, ICanHandleEvent* handler)
+		static constexpr size_t ChunkSize = 1024;
+		static constexpr size_t MaxChunks = 256; // ÿ߳ౣ ChunkSize * MaxChunks ¼
+
+		static Tracer& Instance()
+		{
+			static Tracer tracer;
+			return tracer;
+		}
+
+		void SetEnabled(bool enabled) { mEnabled.store(enabled, std::memory_order_relaxed); }
+
+		bool IsEnabled() const { return mEnabled.load(std::memory_order_relaxed); }
+
+		uint64_t Now() const
 		{
+			return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - mEpoch)
+					.count());
+		}
+
+		// ¼һѽ䣬д뵱ǰ̵߳Ļ
+		void Record(const char* category, const char* name, uint64_t start, uint64_t end)
+		{
+			LocalBuffer().Push({ category, name, start, end - start });
+		}
+
+		// Ϊǰ߳ʱΪ߳ʾ
+		void SetThreadName(std::string name)
+		{
+			auto& buffer = LocalBuffer();
 			std::lock_guard<std::mutex> lock(mMutex);
-			mSubscribers[eventType.name()].push_back(handler);
+			buffer.name = std::move(name);
 		}
 
-		void SendEvent(std::shared_ptr<IEvent> event)
+		size_t GetEventCount() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			size_t count = 0;
+			for (auto& buffer : mBuffers)
+				count += buffer->count.load(std::memory_order_acquire);
+			return count;
+		}
+
+		size_t GetDroppedCount() const
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			size_t dropped = 0;
+			for (auto& buffer : mBuffers)
+				dropped += buffer->dropped.load(std::memory_order_relaxed);
+			return dropped;
+		}
+
+		// ռ¼ѷĿ飻ֹͣ׷û߳ڼ¼ʱ
+		void Clear()
 		{
-			std::vector<ICanHandleEvent*> subscribers;
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& buffer : mBuffers)
 			{
-				std::lock_guard<std::mutex> lock(mMutex);
-				auto it = mSubscribers.find(typeid(*event).name());
-				if (it != mSubscribers.end())
+				buffer->count.store(0, std::memory_order_release);
+				buffer->dropped.store(0, std::memory_order_relaxed);
+			}
+		}
+
+		//  Chrome trace JSON׷ٽҲɵãֻдļ¼
+		std::string ExportChromeTrace() const
+		{
+			std::string out = "{\"traceEvents\":[";
+			bool first = true;
+			auto separate = [&]
+			{
+				if (!first)
+					out += ",\n";
+				first = false;
+			};
+			std::unordered_map<const char*, std::string> names;
+			auto nameOf = [&](const char* name) -> const std::string&
+			{
+				auto it = names.find(name);
+				if (it == names.end())
+					it = names.emplace(name, DemangleTypeName(name)).first;
+				return it->second;
+			};
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& buffer : mBuffers)
+			{
+				std::string tid = std::to_string(buffer->threadId);
+				if (!buffer->name.empty())
 				{
-					subscribers = it->second;
+					separate();
+					out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + tid + ",\"args\":{\"name\":";
+					AppendJsonString(out, buffer->name);
+					out += "}}";
+				}
+
+				size_t count = buffer->count.load(std::memory_order_acquire);
+				for (size_t i = 0; i < count; ++i)
+				{
+					const TraceEvent& event = buffer->chunks[i / ChunkSize].load(std::memory_order_relaxed)[i % ChunkSize];
+					separate();
+					out += "{\"name\":";
+					AppendJsonString(out, nameOf(event.name));
+					out += ",\"cat\":";
+					AppendJsonString(out, event.category);
+					out += ",\"ph\":\"X\",\"ts\":";
+					AppendMicroseconds(out, event.start);
+					out += ",\"dur\":";
+					AppendMicroseconds(out, event.duration);
+					out += ",\"pid\":1,\"tid\":" + tid + "}";
 				}
 			}
+			out += "],\"displayTimeUnit\":\"ns\"}\n";
+			return out;
+		}
+
+		void ExportChromeTrace(std::ostream& out) const { out << ExportChromeTrace(); }
+
+	private:
+		/// @brief ̵߳ļ¼ֻ߳д
+		/// д뷽д¼ release  countȡ acquire count ȡ֮ǰļ¼
+		struct Buffer
+		{
+			uint32_t threadId = 0;
+			std::string name; //  mMutex 
+			std::atomic<size_t> count { 0 };
+			std::atomic<size_t> dropped { 0 };
+			std::atomic<TraceEvent*> chunks[MaxChunks] = {};
 
-			for (auto& handler : subscribers)
+			~Buffer()
 			{
-				try
+				for (auto& chunk : chunks)
+					delete[] chunk.load(std::memory_order_relaxed);
+			}
+
+			void Push(const TraceEvent& event)
+			{
+				size_t index = count.load(std::memory_order_relaxed);
+				size_t chunk = index / ChunkSize;
+				if (chunk >= MaxChunks)
 				{
-					handler->HandleEvent(event);
+					dropped.fetch_add(1, std::memory_order_relaxed);
+					return;
 				}
-				catch (const std::exception&)
+				TraceEvent* events = chunks[chunk].load(std::memory_order_relaxed);
+				if (!events)
 				{
+					events = new TraceEvent[ChunkSize];
+					chunks[chunk].store(events, std::memory_order_relaxed);
 				}
+				events[index % ChunkSize] = event;
+				count.store(index + 1, std::memory_order_release);
+			}
+		};
+
+		Tracer() = default;
+
+		// ׷У߳˳¼Կɵ
+		Buffer& LocalBuffer()
+		{
+			thread_local Buffer* buffer = nullptr;
+			if (!buffer)
+			{
+				auto owned = std::make_unique<Buffer>();
+				std::lock_guard<std::mutex> lock(mMutex);
+				owned->threadId = static_cast<uint32_t>(mBuffers.size() + 1);
+				buffer = owned.get();
+				mBuffers.push_back(std::move(owned));
 			}
+			return *buffer;
 		}
 
-		void UnRegisterEvent(std::type_index eventType, ICanHandleEvent* handler)
+		static void AppendJsonString(std::string& out, std::string_view text)
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			auto it = mSubscribers.find(eventType.name());
-			if (it != mSubscribers.end())
+			static const char hex[] = "0123456789abcdef";
+			out += '"';
+			for (char c : text)
 			{
-				auto& handlers = it->second;
-				auto handlerIt = std::find(handlers.begin(), handlers.end(), handler);
-				if (handlerIt != handlers.end())
+				if (c == '"' || c == '\\')
 				{
-					handlers.erase(handlerIt);
-					if (handlers.empty())
-					{
-						mSubscribers.erase(it);
-					}
+					out += '\\';
+					out += c;
+				}
+				else if (static_cast<unsigned char>(c) < 0x20)
+				{
+					out += "\\u00";
+					out += hex[(c >> 4) & 0xF];
+					out += hex[c & 0xF];
+				}
+				else
+				{
+					out += c;
 				}
 			}
+			out += '"';
 		}
 
-		void Clear()
+		// Chrome trace ʱ䵥λΪ΢룬
+		static void AppendMicroseconds(std::string& out, uint64_t nanoseconds)
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			mSubscribers.clear();
+			out += std::to_string(nanoseconds / 1000);
+			uint64_t fraction = nanoseconds % 1000;
+			out += '.';
+			out += static_cast<char>('0' + fraction / 100);
+			out += static_cast<char>('0' + fraction / 10 % 10);
+			out += static_cast<char>('0' + fraction % 10);
 		}
 
-	private:
-		std::mutex mMutex;
-		std::unordered_map<std::string, std::vector<ICanHandleEvent*>> mSubscribers;
+		std::atomic<bool> mEnabled { false };
+		std::chrono::steady_clock::time_point mEpoch = std::chrono::steady_clock::now();
+		mutable std::mutex mMutex;
+		std::vector<std::unique_ptr<Buffer>> mBuffers;
 	};
 
-	// ================ ļܹӿ ================
-
-	/// @brief ܹĽӿ
-	class IArchitecture : public std::enable_shared_from_this<IArchitecture>
+	/// @brief ׷䣬ʱ׷δ򲻼¼
+	class TraceScope
 	{
 	public:
-		virtual ~IArchitecture() = default;
-		// ʵ shared_from_this()
-		virtual std::shared_ptr<IArchitecture> GetSharedFromThis() = 0;
+		TraceScope(const char* category, const char* name)
+			: mCategory(category)
+			, mName(name)
+		{
+			auto& tracer = Tracer::Instance();
+			if (tracer.IsEnabled())
+			{
+				mStart = tracer.Now();
+				mActive = true;
+			}
+		}
 
-		// 
-		virtual void SendCommand(std::unique_ptr<IJCommand> command) = 0;
+		~TraceScope()
+		{
+			if (mActive)
+			{
+				auto& tracer = Tracer::Instance();
+				tracer.Record(mCategory, mName, mStart, tracer.Now());
+			}
+		}
 
-		virtual void Deinit() = 0;
+		TraceScope(const TraceScope&) = delete;
+		TraceScope& operator=(const TraceScope&) = delete;
 
-	protected:
-		// ע
-		virtual void RegisterSystem(std::type_index typeId,
-			std::shared_ptr<ISystem> system)
-			= 0;
-		virtual void RegisterModel(std::type_index typeId,
-			std::shared_ptr<IModel> model)
-			= 0;
-		virtual void RegisterUtility(std::type_index typeId,
-			std::shared_ptr<IUtility> utility)
-			= 0;
+	private:
+		const char* mCategory;
+		const char* mName;
+		uint64_t mStart = 0;
+		bool mActive = false;
+	};
 
-		// ȡ
-		virtual std::shared_ptr<ISystem> GetSystem(std::type_index typeId) = 0;
-		virtual std::shared_ptr<IModel> GetModel(std::type_index typeId) = 0;
-		virtual std::shared_ptr<IUtility> GetUtility(std::type_index typeId) = 0;
+#if JFRAMEWORK_ENABLE_TRACING
+#define JFRAMEWORK_TRACE_SCOPE(category, name) \
+	::JFramework::TraceScope JFRAMEWORK_CONCAT(jframeworkTraceScope, __LINE__)(category, name)
+#else
+#define JFRAMEWORK_TRACE_SCOPE(category, name) ((void)0)
+#endif
 
-		// ¼
-		virtual void SendEvent(std::shared_ptr<IEvent> event) = 0;
-		virtual void RegisterEvent(std::type_index eventType,
-			ICanHandleEvent* handler)
-			= 0;
-		virtual void UnRegisterEvent(std::type_index eventType,
-			ICanHandleEvent* handler)
-			= 0;
+	// ================ ͳ ================
 
+	/// @brief ѷĿܲ
+	enum class AllocationOperation
+	{
+		None, // ܲ紦ѯû
+		SendEvent,
+		RegisterEvent,
+		UnRegisterEvent,
+		Command,
+		Query,
+		GetComponent,
+		RegisterComponent,
+		PropertySet,
+		PropertyRegister,
+		Count
+	};
+
+	inline const char* GetAllocationOperationName(AllocationOperation operation)
+	{
+		static const char* const names[] = { "None", "SendEvent", "RegisterEvent", "UnRegisterEvent", "Command",
+			"Query", "GetComponent", "RegisterComponent", "PropertySet", "PropertyRegister" };
+		static_assert(sizeof(names) / sizeof(names[0]) == static_cast<size_t>(AllocationOperation::Count),
+			"names must match AllocationOperation");
+		return names[static_cast<size_t>(operation)];
+	}
+
+	/// @brief ܲͳƶѷֽ
+	/// 뵱ǰ߳ڲ AllocationScopeûΪ None
+	/// һԴļʹ JFRAMEWORK_DEFINE_ALLOCATION_HOOKS() 滻ȫ operator new
+	class AllocationTracker
+	{
 	public:
-		template <typename _Ty>
-		void RegisterSystem(std::shared_ptr<_Ty> system)
+		struct Stats
 		{
-			static_assert(std::is_base_of_v<ISystem, _Ty>,
-				"_Ty must inherit from ISystem");
-			RegisterSystem(typeid(_Ty), std::static_pointer_cast<ISystem>(system));
-		}
+			uint64_t operations = 0;
+			uint64_t allocations = 0;
+			uint64_t bytes = 0;
+		};
 
-		template <typename _Ty>
-		void RegisterModel(std::shared_ptr<_Ty> model)
+		// 滻 operator new ã÷ڴ
+		static void OnAllocate(size_t size) noexcept
 		{
-			static_assert(std::is_base_of_v<IModel, _Ty>,
-				"_Ty must inherit from IModel");
-			RegisterModel(typeid(_Ty), std::static_pointer_cast<IModel>(model));
+			++ThreadAllocations();
+			AllocationOperation operation = Current();
+			if (operation == AllocationOperation::None)
+				return;
+			auto& counters = GetCounters(operation);
+			counters.allocations.fetch_add(1, std::memory_order_relaxed);
+			counters.bytes.fetch_add(size, std::memory_order_relaxed);
 		}
 
-		template <typename _Ty>
-		void RegisterUtility(std::shared_ptr<_Ty> utility)
+		static Stats GetStats(AllocationOperation operation)
 		{
-			if (!utility)
-			{
-				throw std::invalid_argument("IUtility cannot be null");
-			}
-			static_assert(std::is_base_of_v<IUtility, _Ty>,
-				"_Ty must inherit from IUtility");
-			RegisterUtility(typeid(_Ty), std::static_pointer_cast<IUtility>(utility));
+			auto& counters = GetCounters(operation);
+			return { counters.operations.load(std::memory_order_relaxed),
+				counters.allocations.load(std::memory_order_relaxed),
+				counters.bytes.load(std::memory_order_relaxed) };
 		}
 
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetSystem()
+		static void Reset()
 		{
-			auto system = GetSystem(typeid(_Ty));
-			if (!system)
+			for (size_t i = 0; i < static_cast<size_t>(AllocationOperation::Count); ++i)
 			{
-				throw ComponentNotRegisteredException(typeid(_Ty).name());
+				auto& counters = GetCounters(static_cast<AllocationOperation>(i));
+				counters.operations.store(0, std::memory_order_relaxed);
+				counters.allocations.store(0, std::memory_order_relaxed);
+				counters.bytes.store(0, std::memory_order_relaxed);
 			}
-			return std::dynamic_pointer_cast<_Ty>(system);
 		}
 
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetModel()
+		// ÿִйĲһУֽÿβƽֵ
+		static std::string Report()
 		{
-			auto model = GetModel(typeid(_Ty));
-			if (!model)
+			std::string report;
+			char line[160];
+			std::snprintf(line, sizeof(line), "%-18s %12s %12s %14s %10s %12s\n",
+				"operation", "count", "allocs", "bytes", "allocs/op", "bytes/op");
+			report += line;
+			for (size_t i = 1; i < static_cast<size_t>(AllocationOperation::Count); ++i)
 			{
-				throw ComponentNotRegisteredException(typeid(_Ty).name());
+				auto operation = static_cast<AllocationOperation>(i);
+				Stats stats = GetStats(operation);
+				if (stats.operations == 0)
+					continue;
+				std::snprintf(line, sizeof(line), "%-18s %12llu %12llu %14llu %10.2f %12.1f\n",
+					GetAllocationOperationName(operation),
+					static_cast<unsigned long long>(stats.operations),
+					static_cast<unsigned long long>(stats.allocations),
+					static_cast<unsigned long long>(stats.bytes),
+					static_cast<double>(stats.allocations) / static_cast<double>(stats.operations),
+					static_cast<double>(stats.bytes) / static_cast<double>(stats.operations));
+				report += line;
 			}
-			return std::dynamic_pointer_cast<_Ty>(model);
+			return report;
 		}
 
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetUtility()
+		// ʼֲ߳̾operator new κʱ̵öȫ
+		static AllocationOperation& Current()
 		{
-			auto utility = GetUtility(typeid(_Ty));
-			if (!utility)
-			{
-				throw ComponentNotRegisteredException(typeid(_Ty).name());
-			}
-			return std::dynamic_pointer_cast<_Ty>(utility);
+			thread_local AllocationOperation current = AllocationOperation::None;
+			return current;
 		}
 
-		template <typename _Ty>
-		void RegisterEvent(ICanHandleEvent* handler)
+		static void CountOperation(AllocationOperation operation)
 		{
-			if (!handler)
-			{
-				throw std::invalid_argument("ICanHandleEvent cannot be null");
-			}
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
-			mEventBus->RegisterEvent(typeid(_Ty), handler);
+			GetCounters(operation).operations.fetch_add(1, std::memory_order_relaxed);
 		}
 
-		template <typename _Ty>
-		void UnRegisterEvent(ICanHandleEvent* handler)
-		{
-			if (!handler)
-			{
-				throw std::invalid_argument("ICanHandleEvent cannot be null");
-			}
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
-			mEventBus->UnRegisterEvent(typeid(_Ty), handler);
-		}
+		// ǰ̵߳ȫѷû룩ζȡ֮һδķ
+		static uint64_t GetThreadAllocationCount() { return ThreadAllocations(); }
 
-		template <typename _Ty, typename... Args>
-		void SendEvent(Args&&... args)
+	private:
+		static uint64_t& ThreadAllocations()
 		{
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
-			this->SendEvent(std::make_shared<_Ty>(std::forward<Args>(args)...));
+			thread_local uint64_t count = 0;
+			return count;
 		}
 
-		template <typename _Ty, typename... Args>
-		void SendCommand(Args&&... args)
+		struct Counters
 		{
-			static_assert(std::is_base_of_v<IJCommand, _Ty>,
-				"_Ty must inherit from ICommand");
-			this->SendCommand(std::make_unique<_Ty>(std::forward<Args>(args)...));
-		}
+			std::atomic<uint64_t> operations { 0 };
+			std::atomic<uint64_t> allocations { 0 };
+			std::atomic<uint64_t> bytes { 0 };
+		};
 
-		// ----------------------------------Query--------------------------------------//
-		template <typename _Ty>
-		auto SendQuery(std::unique_ptr<_Ty> query) -> decltype(query->Do())
+		static Counters& GetCounters(AllocationOperation operation)
 		{
-			static_assert(std::is_base_of_v<IQuery<decltype(query->Do())>, _Ty>,
-				"_Ty must inherit from IQuery");
-
-			if (!query)
-			{
-				throw std::invalid_argument("Query cannot be null");
-			}
-			query->SetArchitecture(GetSharedFromThis());
-			return query->Do();
+			static Counters counters[static_cast<size_t>(AllocationOperation::Count)];
+			return counters[static_cast<size_t>(operation)];
 		}
+	};
 
-		template <typename _Ty, typename... Args>
-		auto SendQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+	/// @brief ڵķ operation
+	/// ֱǶ׵ͬ SendEvent ģת EventBus::SendEventֻһ
+	class AllocationScope
+	{
+	public:
+		explicit AllocationScope(AllocationOperation operation)
+			: mPrevious(AllocationTracker::Current())
 		{
-			static_assert(
-				std::is_base_of_v<IQuery<decltype(std::declval<_Ty>().Do())>, _Ty>,
-				"_Ty must inherit from IQuery");
-
-			auto query = std::make_unique<_Ty>(std::forward<Args>(args)...);
-			return this->SendQuery(std::move(query));
+			if (operation != AllocationOperation::None && operation != mPrevious)
+				AllocationTracker::CountOperation(operation);
+			AllocationTracker::Current() = operation;
 		}
 
-		bool IsInitialized() const { return mInitialized; }
+		~AllocationScope() { AllocationTracker::Current() = mPrevious; }
 
-	protected:
-		bool mInitialized = false;
-		std::unique_ptr<IOCContainer> mContainer;
-		std::unique_ptr<EventBus> mEventBus;
+		AllocationScope(const AllocationScope&) = delete;
+		AllocationScope& operator=(const AllocationScope&) = delete;
+
+	private:
+		AllocationOperation mPrevious;
 	};
 
-	// ================ ӿ ================
-
-	// עӿ
-	class IUnRegister
+#if JFRAMEWORK_ENABLE_ALLOCATION_TRACKING
+#define JFRAMEWORK_ALLOCATION_SCOPE(operation) \
+	::JFramework::AllocationScope JFRAMEWORK_CONCAT(jframeworkAllocationScope, __LINE__)( \
+		::JFramework::AllocationOperation::operation)
+// GCC  free Ϊ operator new ƥ
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#define JFRAMEWORK_ALLOCATION_HOOKS_BEGIN \
+	_Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Wmismatched-new-delete\"")
+#define JFRAMEWORK_ALLOCATION_HOOKS_END _Pragma("GCC diagnostic pop")
+#else
+#define JFRAMEWORK_ALLOCATION_HOOKS_BEGIN
+#define JFRAMEWORK_ALLOCATION_HOOKS_END
+#endif
+// һԴļȫʹã滻ȫ operator new/delete ͳƷ
+#define JFRAMEWORK_DEFINE_ALLOCATION_HOOKS() \
+	JFRAMEWORK_ALLOCATION_HOOKS_BEGIN \
+	void* operator new(std::size_t size) \
+	{ \
+		::JFramework::AllocationTracker::OnAllocate(size); \
+		if (void* pointer = std::malloc(size ? size : 1)) \
+			return pointer; \
+		throw std::bad_alloc(); \
+	} \
+	void* operator new[](std::size_t size) { return ::operator new(size); } \
+	void operator delete(void* pointer) noexcept { std::free(pointer); } \
+	void operator delete[](void* pointer) noexcept { std::free(pointer); } \
+	void operator delete(void* pointer, std::size_t) noexcept { std::free(pointer); } \
+	void operator delete[](void* pointer, std::size_t) noexcept { std::free(pointer); } \
+	JFRAMEWORK_ALLOCATION_HOOKS_END
+#else
+#define JFRAMEWORK_ALLOCATION_SCOPE(operation) ((void)0)
+#define JFRAMEWORK_DEFINE_ALLOCATION_HOOKS()
+#endif
+
+	// ================  ================
+
+	/// @brief λõͳƣͬһλõл
+	struct LockSiteStats
 	{
-	public:
-		virtual ~IUnRegister() = default;
-		virtual void UnRegister() = 0;
+		std::string name;
+		uint64_t acquisitions = 0;
+		uint64_t contended = 0;             // ״γʧܡҪȴĴ
+		std::chrono::nanoseconds wait {};    // ۼƵȴʱ
+		std::chrono::nanoseconds maxWait {}; // ȴ
+		std::chrono::nanoseconds hold {};    // ۼƳʱ
 	};
 
-	class UnRegisterTrigger
+	/// @brief λû ProfiledMutex ͳ
+	class LockProfiler
 	{
 	public:
-		virtual ~UnRegisterTrigger() { this->UnRegister(); }
+		struct Site
+		{
+			const std::string name;
+			std::atomic<uint64_t> acquisitions { 0 };
+			std::atomic<uint64_t> contended { 0 };
+			std::atomic<uint64_t> waitNanoseconds { 0 };
+			std::atomic<uint64_t> maxWaitNanoseconds { 0 };
+			std::atomic<uint64_t> holdNanoseconds { 0 };
+
+			explicit Site(std::string siteName)
+				: name(std::move(siteName))
+			{
+			}
+		};
 
-		void AddUnRegister(std::shared_ptr<IUnRegister> unRegister)
+		static LockProfiler& Instance()
+		{
+			static LockProfiler profiler;
+			return profiler;
+		}
+
+		// ͬλ÷ͬһ󣬵ַڽڱֲ
+		Site& GetSite(const char* name)
 		{
 			std::lock_guard<std::mutex> lock(mMutex);
-			mUnRegisters.push_back(std::move(unRegister));
+			auto& site = mSites[name];
+			if (!site)
+				site = std::make_unique<Site>(name);
+			return *site;
 		}
 
-		void UnRegister()
+		// ۼƵȴʱ併ΰ
+		std::vector<LockSiteStats> GetStats() const
+		{
+			std::vector<LockSiteStats> stats;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				for (auto& [name, site] : mSites)
+				{
+					stats.push_back({ name,
+						site->acquisitions.load(std::memory_order_relaxed),
+						site->contended.load(std::memory_order_relaxed),
+						std::chrono::nanoseconds(site->waitNanoseconds.load(std::memory_order_relaxed)),
+						std::chrono::nanoseconds(site->maxWaitNanoseconds.load(std::memory_order_relaxed)),
+						std::chrono::nanoseconds(site->holdNanoseconds.load(std::memory_order_relaxed)) });
+				}
+			}
+			std::sort(stats.begin(), stats.end(), [](const LockSiteStats& a, const LockSiteStats& b)
+				{
+					if (a.wait != b.wait)
+						return a.wait > b.wait;
+					return a.acquisitions > b.acquisitions;
+				});
+			return stats;
+		}
+
+		void Reset()
 		{
 			std::lock_guard<std::mutex> lock(mMutex);
-			for (auto& unRegister : mUnRegisters)
+			for (auto& [name, site] : mSites)
 			{
-				unRegister->UnRegister();
+				site->acquisitions.store(0, std::memory_order_relaxed);
+				site->contended.store(0, std::memory_order_relaxed);
+				site->waitNanoseconds.store(0, std::memory_order_relaxed);
+				site->maxWaitNanoseconds.store(0, std::memory_order_relaxed);
+				site->holdNanoseconds.store(0, std::memory_order_relaxed);
 			}
-			mUnRegisters.clear();
 		}
 
-	protected:
-		std::mutex mMutex;
-		std::vector<std::shared_ptr<IUnRegister>> mUnRegisters;
+		// ÿλһУ GetStats ˳
+		std::string Report() const
+		{
+			std::string report;
+			char line[200];
+			std::snprintf(line, sizeof(line), "%-28s %12s %10s %8s %12s %12s %12s %12s\n",
+				"site", "acquisitions", "contended", "rate", "wait(us)", "maxwait(us)", "hold(us)", "avghold(ns)");
+			report += line;
+			for (auto& stats : GetStats())
+			{
+				if (stats.acquisitions == 0)
+					continue;
+				std::snprintf(line, sizeof(line), "%-28s %12llu %10llu %7.2f%% %12.1f %12.1f %12.1f %12.1f\n",
+					stats.name.c_str(),
+					static_cast<unsigned long long>(stats.acquisitions),
+					static_cast<unsigned long long>(stats.contended),
+					100.0 * static_cast<double>(stats.contended) / static_cast<double>(stats.acquisitions),
+					static_cast<double>(stats.wait.count()) / 1000.0,
+					static_cast<double>(stats.maxWait.count()) / 1000.0,
+					static_cast<double>(stats.hold.count()) / 1000.0,
+					static_cast<double>(stats.hold.count()) / static_cast<double>(stats.acquisitions));
+				report += line;
+			}
+			return report;
+		}
+
+	private:
+		LockProfiler() = default;
+
+		mutable std::mutex mMutex;
+		std::unordered_map<std::string, std::unique_ptr<Site>> mSites;
 	};
 
-	template <typename _Ty>
-	class BindablePropertyUnRegister
-		: public IUnRegister,
-		public std::enable_shared_from_this<BindablePropertyUnRegister<_Ty>>
+	/// @brief ¼ȴʱĻ
+	///  try_lockʧʱżʱȴδļֻȡʱ
+	class ProfiledMutex
 	{
 	public:
-		BindablePropertyUnRegister(int id,
-			BindableProperty<_Ty>* property,
-			std::function<void(_Ty)> callback)
-			: mProperty(property)
-			, mCallback(std::move(callback))
-			, mId(id)
+		explicit ProfiledMutex(const char* site)
+			: mSite(LockProfiler::Instance().GetSite(site))
 		{
 		}
-		void UnRegisterWhenObjectDestroyed(UnRegisterTrigger* unRegisterTrigger)
+
+		ProfiledMutex(const ProfiledMutex&) = delete;
+		ProfiledMutex& operator=(const ProfiledMutex&) = delete;
+
+		void lock()
 		{
-			unRegisterTrigger->AddUnRegister(this->shared_from_this());
+			if (!mMutex.try_lock())
+			{
+				auto start = std::chrono::steady_clock::now();
+				mMutex.lock();
+				auto wait = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+					std::chrono::steady_clock::now() - start)
+						.count());
+				mSite.contended.fetch_add(1, std::memory_order_relaxed);
+				mSite.waitNanoseconds.fetch_add(wait, std::memory_order_relaxed);
+				uint64_t max = mSite.maxWaitNanoseconds.load(std::memory_order_relaxed);
+				while (wait > max && !mSite.maxWaitNanoseconds.compare_exchange_weak(max, wait, std::memory_order_relaxed))
+				{
+				}
+			}
+			OnAcquired();
 		}
-		int GetId() const { return mId; }
 
-		void SetProperty(BindableProperty<_Ty>* property)
+		bool try_lock()
 		{
-			mProperty = property;
+			if (!mMutex.try_lock())
+				return false;
+			OnAcquired();
+			return true;
 		}
 
-		void UnRegister() override
+		void unlock()
 		{
-			if (mProperty)
+			auto hold = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - mAcquiredAt);
+			mSite.holdNanoseconds.fetch_add(static_cast<uint64_t>(hold.count()), std::memory_order_relaxed);
+			mMutex.unlock();
+		}
+
+	private:
+		// ֻɳдͶȡ
+		void OnAcquired()
+		{
+			mSite.acquisitions.fetch_add(1, std::memory_order_relaxed);
+			mAcquiredAt = std::chrono::steady_clock::now();
+		}
+
+		std::mutex mMutex;
+		LockProfiler::Site& mSite;
+		std::chrono::steady_clock::time_point mAcquiredAt;
+	};
+
+#if JFRAMEWORK_ENABLE_LOCK_PROFILING
+	using FrameworkMutex = ProfiledMutex;
+#else
+	/// @brief ڲȵ㻥Լλ죻δʱ std::mutex
+	class FrameworkMutex : public std::mutex
+	{
+	public:
+		explicit FrameworkMutex(const char*) noexcept {}
+	};
+#endif
+
+	// ================ ̵߳ ================
+
+	/// @brief ̵߳
+	/// ߳ͨ Post Ͷ̵߳ Pump һִͶ
+	/// ͶݶΪߵͶִлͬһʱֻһ̵߳ Pump
+	class Dispatcher
+	{
+	public:
+		Dispatcher() = default;
+		Dispatcher(const Dispatcher&) = delete;
+		Dispatcher& operator=(const Dispatcher&) = delete;
+
+		~Dispatcher()
+		{
+			Node* node = mTail;
+			while (node)
 			{
-				mProperty->UnRegister(mId);
-				mProperty = nullptr; // ֹظ
+				Node* next = node->next.load(std::memory_order_relaxed);
+				if (node != &mStub)
+					delete node;
+				node = next;
 			}
 		}
 
-		void Invoke(_Ty value)
+		void Post(std::function<void()> task)
 		{
-			if (mCallback)
+			Node* node = new Node;
+			node->task = std::move(task);
+			mPendingCount.fetch_add(1, std::memory_order_relaxed);
+			Node* previous = mHead.exchange(node, std::memory_order_acq_rel);
+			previous->next.store(node, std::memory_order_release);
+		}
+
+		// ڵִ߳еǰе񣬷ִ
+		// ִڼͶݵһ Pump
+		size_t Pump()
+		{
+			Node* last = mHead.load(std::memory_order_acquire);
+			size_t count = 0;
+			while (mTail != last)
 			{
-				mCallback(std::move(value));
+				Node* next = mTail->next.load(std::memory_order_acquire);
+				if (!next)
+					break; // δɣһ
+				Node* consumed = mTail;
+				mTail = next;
+				if (consumed != &mStub)
+					delete consumed;
+
+				auto task = std::move(next->task);
+				next->task = nullptr;
+				mPendingCount.fetch_sub(1, std::memory_order_relaxed);
+				++count;
+				try
+				{
+					task();
+				}
+				catch (const std::exception&)
+				{
+				}
 			}
+			return count;
 		}
 
-	protected:
-		int mId;
+		size_t PendingCount() const { return mPendingCount.load(std::memory_order_relaxed); }
 
 	private:
-		BindableProperty<_Ty>* mProperty;
-		std::function<void(_Ty)> mCallback;
+		struct Node
+		{
+			std::atomic<Node*> next { nullptr };
+			std::function<void()> task;
+		};
+
+		Node mStub;
+		std::atomic<Node*> mHead { &mStub }; // ߶ˣͶݵĽڵ
+		Node* mTail = &mStub;                // ߶ˣ Pump ̷߳
+		std::atomic<size_t> mPendingCount { 0 };
 	};
 
-	// ɹ۲
-	template <typename _Ty>
-	class BindableProperty
+	/// @brief ȡҵϵͳ
+	/// ÿ̳߳Լ˫˶У߳ͶݵҵѹԼĶвȳִУ
+	/// ʱͷȡⲿ߳Ͷݵҵ빲ע
+	/// ֻ߳й״̬ҵϵͳԼĹ߳
+	class JobSystem
 	{
 	public:
-		BindableProperty() = default;
-		// ֹͿֵ
-		BindableProperty(const BindableProperty&) = delete;
-		BindableProperty& operator=(const BindableProperty&) = delete;
-		BindableProperty(BindableProperty&& other) noexcept
+		explicit JobSystem(size_t threadCount)
+			: mState(std::make_shared<State>())
 		{
-			std::lock_guard<std::mutex> lock(other.mMutex);
-			mValue = std::move(other.mValue);
-			mObservers = std::move(other.mObservers);
-			mNextId = other.mNextId;
-			// observermPropertyָ
-			for (auto& observer : mObservers)
+			if (threadCount == 0)
+				threadCount = 1;
+			for (size_t i = 0; i < threadCount; ++i)
 			{
-				if (observer)
-					observer->SetProperty(this);
+				mState->queues.push_back(std::make_unique<JobQueue>());
+			}
+			for (size_t i = 0; i < threadCount; ++i)
+			{
+				mThreads.emplace_back(&JobSystem::WorkerLoop, mState, i);
 			}
-			other.mNextId = 0;
 		}
 
-		BindableProperty& operator=(BindableProperty&& other) noexcept
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		~JobSystem()
 		{
-			if (this != &other)
 			{
-				std::lock_guard<std::mutex> lock1(mMutex);
-				std::lock_guard<std::mutex> lock2(other.mMutex);
-				mValue = std::move(other.mValue);
-				mObservers = std::move(other.mObservers);
-				mNextId = other.mNextId;
-				for (auto& observer : mObservers)
-				{
-					if (observer)
-						observer->SetProperty(this);
-				}
-				other.mNextId = 0;
+				std::lock_guard<std::mutex> lock(mState->sleepMutex);
+				mState->stopping = true;
+			}
+			mState->wakeUp.notify_all();
+			for (auto& thread : mThreads)
+			{
+				// ڹ߳ʱ޷ join Լ˳
+				if (thread.get_id() == std::this_thread::get_id())
+					thread.detach();
+				else
+					thread.join();
 			}
-			return *this;
 		}
-		explicit BindableProperty(const _Ty& value)
-			: mValue(std::move(value))
+
+		void Post(std::function<void()> job)
 		{
+			auto& current = CurrentWorker();
+			JobQueue& queue = current.state == mState.get()
+				? *mState->queues[current.index]
+				: mState->injected;
+			{
+				std::lock_guard<std::mutex> lock(queue.mutex);
+				queue.jobs.push_back(std::move(job));
+			}
+			mState->pending.fetch_add(1);
+			//  WorkerLoop е sleeping/pending ԣû߳ʱ
+			if (mState->sleeping.load() > 0)
+			{
+				{ std::lock_guard<std::mutex> lock(mState->sleepMutex); }
+				mState->wakeUp.notify_one();
+			}
 		}
 
-		~BindableProperty()
+		size_t ThreadCount() const { return mThreads.size(); }
+
+		// ڵִ߳һŶҵûпִеҵ false
+		// ȴҵ߳̿ɽЭִУǶ׵ȴʱҵϵͳ
+		//  Model дʱЭҵñ̵߳ѳȴ̳߳е
+		bool TryRunPendingTask()
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			mObservers.clear();
+			if (IsHoldingModelAccess())
+				return false;
+			auto& current = CurrentWorker();
+			size_t index = current.state == mState.get() ? current.index : NoWorker;
+			std::function<void()> job;
+			if (!TakeJob(*mState, index, job))
+				return false;
+			Run(job);
+			return true;
 		}
 
-		// ȡǰֵ
-		const _Ty& GetValue() const { return mValue; }
-
-		// ֵ
-		void SetValue(const _Ty& newValue)
+		/// @brief  [begin, end)  grainSize зΪɿ鲢ִ body(blockBegin, blockEnd)
+		/// ִ̲߳вȴȫɣһ׳쳣ڽ׳
+		/// @param grainSize ÿԪ0 ʾ߳Զз
+		template <typename _Fn>
+		void ParallelFor(size_t begin, size_t end, size_t grainSize, _Fn&& body)
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			if (mValue == newValue)
+			if (begin >= end)
 				return;
-			mValue = newValue;
-			for (auto& observer : mObservers)
+			size_t count = end - begin;
+			if (grainSize == 0)
+				grainSize = std::max<size_t>(1, count / (ThreadCount() * 4 + 4));
+			size_t blockCount = (count + grainSize - 1) / grainSize;
+			if (blockCount == 1)
 			{
-				try
-				{
-					observer->Invoke(mValue);
-				}
-				catch (const std::exception&)
+				body(begin, end);
+				return;
+			}
+
+			auto range = std::make_shared<ParallelRange>();
+			range->begin = begin;
+			range->end = end;
+			range->grainSize = grainSize;
+			range->blockCount = blockCount;
+			range->body = &body;
+			range->invoke = [](void* fn, size_t first, size_t last) { (*static_cast<std::remove_reference_t<_Fn>*>(fn))(first, last); };
+
+			// ߳ȡֱ꣬ٵҵֻӴ״̬ѷص body
+			size_t helpers = std::min(blockCount - 1, ThreadCount());
+			for (size_t i = 0; i < helpers; ++i)
+			{
+				Post([range] { range->RunBlocks(); });
+			}
+			range->RunBlocks();
+			while (range->completed.load(std::memory_order_acquire) < blockCount)
+			{
+				if (!TryRunPendingTask())
+					std::this_thread::yield();
+			}
+			if (range->exception)
+				std::rethrow_exception(range->exception);
+		}
+
+	private:
+		static constexpr size_t NoWorker = static_cast<size_t>(-1);
+
+		struct JobQueue
+		{
+			std::mutex mutex;
+			std::deque<std::function<void()>> jobs;
+		};
+
+		struct State
+		{
+			std::vector<std::unique_ptr<JobQueue>> queues; // ÿ߳һ
+			JobQueue injected;                              // ⲿ߳Ͷ
+			std::atomic<size_t> pending { 0 };
+			std::atomic<size_t> sleeping { 0 };
+			std::atomic<size_t> nextVictim { 0 };
+			std::mutex sleepMutex;
+			std::condition_variable wakeUp;
+			bool stopping = false;
+		};
+
+		struct WorkerContext
+		{
+			State* state = nullptr;
+			size_t index = NoWorker;
+		};
+
+		struct ParallelRange
+		{
+			size_t begin = 0;
+			size_t end = 0;
+			size_t grainSize = 0;
+			size_t blockCount = 0;
+			void* body = nullptr;
+			void (*invoke)(void*, size_t, size_t) = nullptr;
+			std::atomic<size_t> nextBlock { 0 };
+			std::atomic<size_t> completed { 0 };
+			std::atomic<bool> failed { false };
+			std::exception_ptr exception;
+
+			void RunBlocks()
+			{
+				for (;;)
 				{
-					
+					size_t block = nextBlock.fetch_add(1, std::memory_order_relaxed);
+					if (block >= blockCount)
+						return;
+					// ʣĿִֻ
+					if (!failed.load(std::memory_order_relaxed))
+					{
+						size_t first = begin + block * grainSize;
+						size_t last = std::min(end, first + grainSize);
+						try
+						{
+							invoke(body, first, last);
+						}
+						catch (...)
+						{
+							if (!failed.exchange(true))
+								exception = std::current_exception();
+						}
+					}
+					completed.fetch_add(1, std::memory_order_acq_rel);
 				}
 			}
-		}
+		};
 
-		// ֪ͨ
-		void SetValueWithoutEvent(const _Ty& newValue)
+		static WorkerContext& CurrentWorker()
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			mValue = newValue;
+			thread_local WorkerContext context;
+			return context;
 		}
 
-		// ע۲ߣʼֵ֪ͨ
-		std::shared_ptr<BindablePropertyUnRegister<_Ty>> RegisterWithInitValue(
-			std::function<void(const _Ty&)> onValueChanged)
+		static bool PopBack(JobQueue& queue, std::function<void()>& job)
 		{
-			onValueChanged(mValue);
-			return Register(std::move(onValueChanged));
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.jobs.empty())
+				return false;
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+			return true;
 		}
 
-		// ע۲
-		std::shared_ptr<BindablePropertyUnRegister<_Ty>> Register(
-			std::function<void(const _Ty&)> onValueChanged)
+		static bool PopFront(JobQueue& queue, std::function<void()>& job)
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			auto unRegister = std::make_shared<BindablePropertyUnRegister<_Ty>>(
-				mNextId++, this, std::move(onValueChanged));
-			mObservers.push_back(unRegister);
-			return unRegister;
+			std::lock_guard<std::mutex> lock(queue.mutex);
+			if (queue.jobs.empty())
+				return false;
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+			return true;
 		}
 
-		// ע۲
-		void UnRegister(int id)
+		// γԼĶУȳעСȡ̵߳ĶУȽȳ
+		static bool TakeJob(State& state, size_t index, std::function<void()>& job)
 		{
-			std::lock_guard<std::mutex> lock(mMutex);
-			for (size_t i = 0; i < mObservers.size(); i++)
+			if (state.pending.load() == 0)
+				return false;
+
+			bool found = (index != NoWorker && PopBack(*state.queues[index], job)) ||
+				PopFront(state.injected, job);
+			if (!found)
 			{
-				auto& observer = mObservers[i];
-				if (observer && observer->GetId() == id)
+				size_t count = state.queues.size();
+				size_t start = index != NoWorker ? index + 1 : state.nextVictim.fetch_add(1, std::memory_order_relaxed);
+				for (size_t i = 0; i < count && !found; ++i)
 				{
-					mObservers.erase(mObservers.begin() + i);
-					break; // ҵע˳ѭ
+					size_t victim = (start + i) % count;
+					if (victim != index)
+						found = PopFront(*state.queues[victim], job);
 				}
 			}
+			if (found)
+				state.pending.fetch_sub(1);
+			return found;
 		}
 
-		// أʹ
-		operator _Ty() const { return mValue; }
-		BindableProperty<_Ty>& operator=(const _Ty& newValue)
+		static void Run(std::function<void()>& job)
 		{
-			SetValue(std::move(newValue));
-			return *this;
+			try
+			{
+				job();
+			}
+			catch (const std::exception&)
+			{
+			}
+			job = nullptr;
 		}
 
-	private:
-		std::mutex mMutex;
-		int mNextId = 0;
-		_Ty mValue;
-		std::vector<std::shared_ptr<BindablePropertyUnRegister<_Ty>>> mObservers;
-	};
-
-	/// @brief ʼӿ
-	class ICanInit
-	{
-	public:
-		bool IsInitialized() const { return mInitialized; }
-		void SetInitialized(bool initialized) { mInitialized = initialized; }
-		virtual ~ICanInit() = default;
-		virtual void Init() = 0;
-		virtual void Deinit() = 0;
+		static void WorkerLoop(std::shared_ptr<State> state, size_t index)
+		{
+			CurrentWorker() = { state.get(), index };
+			std::function<void()> job;
+			for (;;)
+			{
+				if (TakeJob(*state, index, job))
+				{
+					Run(job);
+					continue;
+				}
 
-	protected:
-		bool mInitialized = false;
-	};
+				std::unique_lock<std::mutex> lock(state->sleepMutex);
+				if (state->stopping)
+					return;
+				state->sleeping.fetch_add(1);
+				state->wakeUp.wait(lock, [&] { return state->stopping || state->pending.load() > 0; });
+				state->sleeping.fetch_sub(1);
+				if (state->stopping)
+					return;
+			}
+		}
 
-	/// @brief ܹӿ
-	class IBelongToArchitecture
-	{
-	public:
-		virtual ~IBelongToArchitecture() = default;
-		virtual std::weak_ptr<IArchitecture> GetArchitecture() const = 0;
+		std::shared_ptr<State> mState;
+		std::vector<std::thread> mThreads;
 	};
 
-	/// @brief ܹýӿ
-	class ICanSetArchitecture
+	/// @brief 첽ִ
+	/// ޼ֱӲִУͬͶ˳ִУ֮ͬ䲢
+	class TaskExecutor
 	{
 	public:
-		virtual ~ICanSetArchitecture() = default;
-		virtual void SetArchitecture(std::shared_ptr<IArchitecture> architecture) = 0;
-	};
+		explicit TaskExecutor(size_t threadCount)
+			: mPool(threadCount)
+		{
+		}
 
-	// ================ ܽӿ ================
+		void Post(std::function<void()> task) { mPool.Post(std::move(task)); }
 
-	/// @brief ȡModel
-	class ICanGetModel : public IBelongToArchitecture
-	{
-	public:
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetModel()
+		void Post(std::type_index key, std::function<void()> task)
 		{
-			static_assert(std::is_base_of_v<IModel, _Ty>,
-				"_Ty must inherit from IModel");
-
-			auto arch = GetArchitecture().lock();
-			if (!arch)
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
+				std::lock_guard<std::mutex> lock(mMutex);
+				auto& queue = mSerialQueues[key];
+				if (queue.running)
+				{
+					queue.tasks.push_back(std::move(task));
+					return;
+				}
+				queue.running = true;
 			}
+			mPool.Post([this, key, task = std::move(task)]() mutable { RunSerial(key, std::move(task)); });
+		}
+
+		size_t ThreadCount() const { return mPool.ThreadCount(); }
+
+		bool TryRunPendingTask() { return mPool.TryRunPendingTask(); }
+
+		JobSystem& GetJobSystem() { return mPool; }
+
+		// ȴ future ڼЭִŶ
+		template <typename _Future>
+		void HelpWhileWaiting(const _Future& future)
+		{
+			while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			{
+				if (!TryRunPendingTask())
+					future.wait_for(std::chrono::microseconds(100));
+			}
+		}
+
+	private:
+		struct SerialQueue
+		{
+			std::deque<std::function<void()>> tasks;
+			bool running = false;
+		};
+
+		void RunSerial(std::type_index key, std::function<void()> task)
+		{
+			try
+			{
+				task();
+			}
+			catch (const std::exception&)
+			{
+			}
+
+			std::function<void()> next;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				auto it = mSerialQueues.find(key);
+				if (it->second.tasks.empty())
+				{
+					mSerialQueues.erase(it);
+				}
+				else
+				{
+					next = std::move(it->second.tasks.front());
+					it->second.tasks.pop_front();
+				}
+			}
+			if (next)
+			{
+				mPool.Post([this, key, next = std::move(next)]() mutable { RunSerial(key, std::move(next)); });
+			}
+			// task ڴ֮еĶ󣨿ִܰߣͷ
+		}
+
+		std::mutex mMutex;
+		std::unordered_map<std::type_index, SerialQueue> mSerialQueues;
+		JobSystem mPool;
+	};
+
+	/// @brief ӳȼ
+	enum class CommandPriority
+	{
+		High,
+		Normal,
+		Low
+	};
+
+	/// @brief ӳͳ
+	struct CommandSchedulerStats
+	{
+		size_t queueDepth = 0;                          // ǰŶ
+		size_t executedLastTick = 0;                    // һִ֡е
+		std::chrono::nanoseconds lastTickTime {};       // һִ֡кʱ
+	};
+
+	/// @brief ¼ӿ
+	class IEvent
+	{
+	public:
+		virtual ~IEvent() = default;
+	};
+
+	/// @brief Event
+	class ICanHandleEvent
+	{
+	public:
+		virtual ~ICanHandleEvent() = default;
+		virtual void HandleEvent(std::shared_ptr<IEvent> event) = 0;
+
+		// ¼߳׺ԣطǿʱ¼Ͷݵõ߳ Pump ʱ
+		// עʱȡദӦڵ߳ע
+		virtual Dispatcher* GetEventDispatcher() const { return nullptr; }
+	};
+
+	/// @brief ¼ʵ
+	class EventBus
+	{
+	public:
+		void RegisterEvent(std::type_index eventType, ICanHandleEvent* handler)
+		{
+			AddSubscriber(eventType, handler, nullptr);
+		}
+
+		// еķַдãעٵ HandleEvent ͷŵĴ
+		void RegisterEvent(std::type_index eventType, std::shared_ptr<ICanHandleEvent> handler)
+		{
+			auto* raw = handler.get();
+			AddSubscriber(eventType, raw, std::move(handler));
+		}
+
+		void SendEvent(std::shared_ptr<IEvent> event)
+		{
+			JFRAMEWORK_TRACE_SCOPE("event", typeid(*event).name());
+			JFRAMEWORK_ALLOCATION_SCOPE(SendEvent);
+			std::vector<Subscriber> subscribers;
+			{
+				std::lock_guard<FrameworkMutex> lock(mMutex);
+				auto it = mSubscribers.find(typeid(*event).name());
+				if (it != mSubscribers.end())
+				{
+					subscribers = it->second;
+				}
+			}
+
+			for (auto& subscriber : subscribers)
+			{
+				if (subscriber.dispatcher)
+				{
+					// ִǰעʱ
+					subscriber.dispatcher->Post([handler = subscriber.handler, owner = subscriber.owner, alive = subscriber.alive, event]
+						{
+							if (alive->load(std::memory_order_acquire))
+							{
+								JFRAMEWORK_TRACE_SCOPE("handler", typeid(*handler).name());
+								JFRAMEWORK_ALLOCATION_SCOPE(None);
+								handler->HandleEvent(event);
+							}
+						});
+					continue;
+				}
+
+				try
+				{
+					JFRAMEWORK_TRACE_SCOPE("handler", typeid(*subscriber.handler).name());
+					JFRAMEWORK_ALLOCATION_SCOPE(None);
+					subscriber.handler->HandleEvent(event);
+				}
+				catch (const std::exception&)
+				{
+				}
+			}
+		}
+
+		void UnRegisterEvent(std::type_index eventType, ICanHandleEvent* handler)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(UnRegisterEvent);
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto it = mSubscribers.find(eventType.name());
+			if (it != mSubscribers.end())
+			{
+				auto& handlers = it->second;
+				auto handlerIt = std::find_if(handlers.begin(), handlers.end(),
+					[&](const Subscriber& subscriber) { return subscriber.handler == handler; });
+				if (handlerIt != handlers.end())
+				{
+					if (handlerIt->alive)
+						handlerIt->alive->store(false, std::memory_order_release);
+					handlers.erase(handlerIt);
+					if (handlers.empty())
+					{
+						mSubscribers.erase(it);
+					}
+				}
+			}
+		}
+
+		void Clear()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (auto& [name, handlers] : mSubscribers)
+			{
+				for (auto& subscriber : handlers)
+				{
+					if (subscriber.alive)
+						subscriber.alive->store(false, std::memory_order_release);
+				}
+			}
+			mSubscribers.clear();
+		}
+
+	private:
+		struct Subscriber
+		{
+			ICanHandleEvent* handler;
+			Dispatcher* dispatcher;                  // Ϊʱڷ߳ͬ
+			std::shared_ptr<std::atomic<bool>> alive; // ͶݵĴʹ
+			std::shared_ptr<ICanHandleEvent> owner;   //  shared_ptr עĴ
+		};
+
+		void AddSubscriber(std::type_index eventType, ICanHandleEvent* handler, std::shared_ptr<ICanHandleEvent> owner)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(RegisterEvent);
+			Subscriber subscriber { handler, handler->GetEventDispatcher(), nullptr, std::move(owner) };
+			if (subscriber.dispatcher)
+				subscriber.alive = std::make_shared<std::atomic<bool>>(true);
+
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			mSubscribers[eventType.name()].push_back(std::move(subscriber));
+		}
+
+		FrameworkMutex mMutex { "EventBus::mMutex" };
+		std::unordered_map<std::string, std::vector<Subscriber>> mSubscribers;
+	};
+
+	// ================ ļܹӿ ================
+
+	/// @brief ܹĽӿ
+	class IArchitecture : public std::enable_shared_from_this<IArchitecture>
+	{
+	public:
+		virtual ~IArchitecture() = default;
+		// ʵ shared_from_this()
+		virtual std::shared_ptr<IArchitecture> GetSharedFromThis() = 0;
+
+		// 
+		virtual void SendCommand(std::unique_ptr<IJCommand> command) = 0;
+
+		// ִͳһڣɵ÷Уλջϣ
+		virtual void ExecuteCommand(IJCommand& command) = 0;
+
+		// ڿ̳߳첽ִɻ׳쳣ʱ future 
+		virtual std::future<void> SendCommandAsync(std::unique_ptr<IJCommand> command) = 0;
+
+		// ӣ Tick ֡Ԥִ
+		virtual void EnqueueCommand(std::unique_ptr<IJCommand> command,
+			CommandPriority priority = CommandPriority::Normal)
+			= 0;
+
+		// Ͷݵ dispatcher߳ Pump ʱִУʱܹ
+		virtual void PostCommand(std::unique_ptr<IJCommand> command, Dispatcher& dispatcher) = 0;
+
+		// ָʱؼ¼õע򷵻 nullptr
+		virtual MetricsRegistry* GetFrameworkMetrics() { return nullptr; }
+
+		virtual void Deinit() = 0;
+
+	protected:
+		// ע
+		virtual void RegisterSystem(std::type_index typeId,
+			std::shared_ptr<ISystem> system)
+			= 0;
+		virtual void RegisterModel(std::type_index typeId,
+			std::shared_ptr<IModel> model)
+			= 0;
+		virtual void RegisterUtility(std::type_index typeId,
+			std::shared_ptr<IUtility> utility)
+			= 0;
+
+		// ȡ
+		virtual std::shared_ptr<ISystem> GetSystem(std::type_index typeId) = 0;
+		virtual std::shared_ptr<IModel> GetModel(std::type_index typeId) = 0;
+		virtual std::shared_ptr<IUtility> GetUtility(std::type_index typeId) = 0;
+
+		// עעʱı䣻 0 ʾ GetModelRef/GetSystemRef Ĳҽ
+		virtual uint64_t GetComponentGeneration() const { return 0; }
+
+		// ¼
+		virtual void SendEvent(std::shared_ptr<IEvent> event) = 0;
+		virtual void RegisterEvent(std::type_index eventType,
+			ICanHandleEvent* handler)
+			= 0;
+		virtual void UnRegisterEvent(std::type_index eventType,
+			ICanHandleEvent* handler)
+			= 0;
+
+	public:
+		template <typename _Ty>
+		void RegisterSystem(std::shared_ptr<_Ty> system)
+		{
+			static_assert(std::is_base_of_v<ISystem, _Ty>,
+				"_Ty must inherit from ISystem");
+			RegisterSystem(typeid(_Ty), std::static_pointer_cast<ISystem>(system));
+		}
+
+		template <typename _Ty>
+		void RegisterModel(std::shared_ptr<_Ty> model)
+		{
+			static_assert(std::is_base_of_v<IModel, _Ty>,
+				"_Ty must inherit from IModel");
+			RegisterModel(typeid(_Ty), std::static_pointer_cast<IModel>(model));
+		}
+
+		template <typename _Ty>
+		void RegisterUtility(std::shared_ptr<_Ty> utility)
+		{
+			if (!utility)
+			{
+				throw std::invalid_argument("IUtility cannot be null");
+			}
+			static_assert(std::is_base_of_v<IUtility, _Ty>,
+				"_Ty must inherit from IUtility");
+			RegisterUtility(typeid(_Ty), std::static_pointer_cast<IUtility>(utility));
+		}
+
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetSystem()
+		{
+			auto system = GetSystem(typeid(_Ty));
+			if (!system)
+			{
+				throw ComponentNotRegisteredException(typeid(_Ty).name());
+			}
+			return std::dynamic_pointer_cast<_Ty>(system);
+		}
+
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetModel()
+		{
+			auto model = GetModel(typeid(_Ty));
+			if (!model)
+			{
+				throw ComponentNotRegisteredException(typeid(_Ty).name());
+			}
+			TrackModelAccess(model);
+			return std::dynamic_pointer_cast<_Ty>(model);
+		}
+
+		// ӵе System ã System עڱܹڼЧ
+		// ̻߳ҽעδ仯ʱüԭӲ
+		template <typename _Ty>
+		_Ty& GetSystemRef()
+		{
+			return *FindComponent<_Ty, ISystem>();
+		}
+
+		// ӵе Model ã Model עڱܹڼЧҷʽͬ GetSystemRef
+		template <typename _Ty>
+		_Ty& GetModelRef()
+		{
+			auto* model = FindComponent<_Ty, IModel>();
+			if (!TrackModelAccess(model))
+				TrackModelAccess(GetModel(typeid(_Ty)));
+			return *model;
+		}
+
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetUtility()
+		{
+			auto utility = GetUtility(typeid(_Ty));
+			if (!utility)
+			{
+				throw ComponentNotRegisteredException(typeid(_Ty).name());
+			}
+			return std::dynamic_pointer_cast<_Ty>(utility);
+		}
+
+		template <typename _Ty>
+		void RegisterEvent(ICanHandleEvent* handler)
+		{
+			if (!handler)
+			{
+				throw std::invalid_argument("ICanHandleEvent cannot be null");
+			}
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+			mEventBus->RegisterEvent(typeid(_Ty), handler);
+		}
+
+		//  shared_ptr Уڷַ;עͷʱʹãͨ handler.get() ע
+		template <typename _Ty>
+		void RegisterEvent(std::shared_ptr<ICanHandleEvent> handler)
+		{
+			if (!handler)
+			{
+				throw std::invalid_argument("ICanHandleEvent cannot be null");
+			}
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+			mEventBus->RegisterEvent(typeid(_Ty), std::move(handler));
+		}
+
+		template <typename _Ty>
+		void UnRegisterEvent(ICanHandleEvent* handler)
+		{
+			if (!handler)
+			{
+				throw std::invalid_argument("ICanHandleEvent cannot be null");
+			}
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+			mEventBus->UnRegisterEvent(typeid(_Ty), handler);
+		}
+
+		template <typename _Ty, typename... Args>
+		void SendEvent(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+			// ¼ķ SendEvent
+			JFRAMEWORK_ALLOCATION_SCOPE(SendEvent);
+			this->SendEvent(std::make_shared<_Ty>(std::forward<Args>(args)...));
+		}
+
+		template <typename _Ty, typename... Args>
+		void SendCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from ICommand");
+			// ֱͬջϹ죬ִ꼴٣ѷ
+			_Ty command(std::forward<Args>(args)...);
+			this->ExecuteCommand(command);
+		}
+
+		template <typename _Ty, typename... Args>
+		std::future<void> SendCommandAsync(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from ICommand");
+			return this->SendCommandAsync(std::make_unique<_Ty>(std::forward<Args>(args)...));
+		}
+
+		template <typename _Ty, typename... Args>
+		void EnqueueCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from ICommand");
+			this->EnqueueCommand(std::make_unique<_Ty>(std::forward<Args>(args)...));
+		}
+
+		template <typename _Ty, typename... Args>
+		void PostCommand(Dispatcher& dispatcher, Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from ICommand");
+			this->PostCommand(std::make_unique<_Ty>(std::forward<Args>(args)...), dispatcher);
+		}
+
+		// ----------------------------------Query--------------------------------------//
+		template <typename _Ty>
+		auto SendQuery(std::unique_ptr<_Ty> query) -> decltype(query->Do())
+		{
+			static_assert(std::is_base_of_v<IQuery<decltype(query->Do())>, _Ty>,
+				"_Ty must inherit from IQuery");
+
+			if (!query)
+			{
+				throw std::invalid_argument("Query cannot be null");
+			}
+			// ѯڱִϲ֮٣ʹ÷ӵо
+			query->SetArchitectureHandle(this);
+			return DoGuardedQuery(*this, *query);
+		}
+
+		template <typename _Ty, typename... Args>
+		auto SendQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+		{
+			static_assert(
+				std::is_base_of_v<IQuery<decltype(std::declval<_Ty>().Do())>, _Ty>,
+				"_Ty must inherit from IQuery");
+
+			// ѯֱջϹ죬ִ꼴٣ѷ
+			_Ty query(std::forward<Args>(args)...);
+			query.SetArchitectureHandle(this);
+			return DoGuardedQuery(*this, query);
+		}
+
+		// ĲѯԲѯͺͲΪ Model 汾δ仯ʱֱӷػ
+		// ɿɱȽ֧ std::hashɿ
+		template <typename _Ty, typename... Args>
+		auto SendCachedQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do());
+
+		virtual QueryCache& GetQueryCache() = 0;
+
+		// ִжѯ˳򷵻ؽԪ
+		// IsReadOnly() Ϊ true Ĳѯڿ̳߳ϲִУڵִ߳
+		// ̳߳ Model дʱ˷ʵУȫڵִ߳
+		// һѯ׳쳣вѯ׳
+		template <typename... _Queries>
+		auto SendQueries(std::unique_ptr<_Queries>... queries)
+			-> std::tuple<decltype(std::declval<_Queries>().Do())...>;
+
+		// ̳߳أ첽вѯϵͳ¾ҵϵͳִ
+		virtual TaskExecutor& GetTaskExecutor() = 0;
+
+		// ܹеĹȡҵϵͳӦʹԽ߳
+		JobSystem& GetJobSystem() { return GetTaskExecutor().GetJobSystem(); }
+
+#if JFRAMEWORK_HAS_COROUTINES
+		// ----------------------------------Coroutine--------------------------------------//
+
+		// Эִеһ㣬֮ Tick ָ׳쳣ʱ future 
+		virtual std::future<void> SendCoroutineCommand(std::unique_ptr<ICoroutineCommand> command) = 0;
+
+		template <typename _Ty, typename... Args>
+		std::future<void> SendCoroutineCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<ICoroutineCommand, _Ty>,
+				"_Ty must inherit from ICoroutineCommand");
+			return this->SendCoroutineCommand(std::make_unique<_Ty>(std::forward<Args>(args)...));
+		}
+
+		// Э̲ѯȷʽЭͬͨ future 
+		template <typename _Ty, typename... Args>
+		auto SendCoroutineQuery(Args&&... args)
+			-> std::future<typename decltype(std::declval<_Ty>().DoAsync())::value_type>;
+
+		virtual CoroutineScheduler& GetCoroutineScheduler() = 0;
+#endif
+
+		// ɳʷ¼
+		virtual CommandHistory& GetCommandHistory() = 0;
+
+		// ----------------------------------Timer--------------------------------------//
+
+		// ܶʱ Tick ƽ
+		virtual TimerService& GetTimerService() = 0;
+
+		// ӳ delay ¼
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> SendEventAfter(std::chrono::nanoseconds delay, Args&&... args);
+
+		// ÿ period һ¼ֱȡ
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> SendEventEvery(std::chrono::nanoseconds period, Args&&... args);
+
+		// ӳ delay ӣͬһ Tick ִ
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> EnqueueCommandAfter(std::chrono::nanoseconds delay, Args&&... args);
+
+		// ÿ period ͬһӣֱȡ
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> EnqueueCommandEvery(std::chrono::nanoseconds period, Args&&... args);
+
+		bool IsInitialized() const { return mInitialized; }
+
+	protected:
+		friend class ModelAccessGuard;
+		friend class AbstractUndoableCommand;
+
+		bool mInitialized = false;
+		std::unique_ptr<IOCContainer> mContainer;
+		std::unique_ptr<EventBus> mEventBus;
+
+	private:
+		// ÿ̰߳ͻһεĲҽԼܹעΪ
+		// ȫΨһܹٺַʱͬʧЧ
+		template <typename _Ty, typename _Base>
+		_Ty* FindComponent()
+		{
+			static_assert(std::is_base_of_v<_Base, _Ty>, "_Ty must inherit from the component interface");
+
+			struct Cache
+			{
+				const IArchitecture* architecture = nullptr;
+				uint64_t generation = 0;
+				_Ty* component = nullptr;
+			};
+			thread_local Cache cache;
+			uint64_t generation = GetComponentGeneration();
+			if (generation != 0 && cache.architecture == this && cache.generation == generation)
+				return cache.component;
+
+			std::shared_ptr<_Base> component;
+			if constexpr (std::is_same_v<_Base, IModel>)
+				component = GetModel(typeid(_Ty));
+			else
+				component = GetSystem(typeid(_Ty));
+			auto* typed = dynamic_cast<_Ty*>(component.get());
+			if (!typed)
+			{
+				throw ComponentNotRegisteredException(typeid(_Ty).name());
+			}
+			cache = { this, generation, typed };
+			return typed;
+		}
+	};
+
+	// ================ ¼ ================
+
+	/// @brief ɳĵ
+	class IUndoableChange
+	{
+	public:
+		virtual ~IUndoableChange() = default;
+		virtual void Undo() = 0;
+		virtual void Redo() = 0;
+		// ռõڴֽʷ¼ڴ
+		virtual size_t GetSize() const = 0;
+	};
+
+	/// @brief һοɳȫ
+	struct ChangeSet
+	{
+		std::vector<std::unique_ptr<IUndoableChange>> changes;
+		std::vector<std::weak_ptr<IModel>> models; // ʻд Model/汾
+		size_t size = 0;
+
+		void Add(std::unique_ptr<IUndoableChange> change)
+		{
+			size += change->GetSize();
+			changes.push_back(std::move(change));
+		}
+
+		void AddModel(const std::shared_ptr<IModel>& model)
+		{
+			if (!Covers(model.get()))
+				models.push_back(model);
+		}
+
+		bool Covers(const IModel* model) const
+		{
+			return model && std::any_of(models.begin(), models.end(),
+				[model](const std::weak_ptr<IModel>& m) { return m.lock().get() == model; });
+		}
+
+		void Undo()
+		{
+			for (auto it = changes.rbegin(); it != changes.rend(); ++it)
+			{
+				(*it)->Undo();
+			}
+		}
+
+		void Redo()
+		{
+			for (auto& change : changes)
+			{
+				change->Redo();
+			}
+		}
+
+		bool Empty() const { return changes.empty(); }
+	};
+
+	/// @brief ǰ̵߳ı¼Ŀ
+	/// ɳִڼ䣬ʻд Model Ǽǵ BindableProperty ޸ʽ¼ǰ ChangeSet
+	/// δǼ Model ԣ״̬볷ʷ
+	class ChangeRecorder
+	{
+	public:
+		static bool IsRecording() { return Current() != nullptr; }
+
+		static bool IsRecording(const IModel* owner)
+		{
+			auto* changeSet = Current();
+			return changeSet && changeSet->Covers(owner);
+		}
+
+		static void AddModel(const std::shared_ptr<IModel>& model)
+		{
+			if (auto* changeSet = Current())
+				changeSet->AddModel(model);
+		}
+
+		static void Record(std::unique_ptr<IUndoableChange> change)
+		{
+			if (auto* changeSet = Current())
+				changeSet->Add(std::move(change));
+		}
+
+	private:
+		friend class ChangeRecordScope;
+
+		static ChangeSet*& Current()
+		{
+			thread_local ChangeSet* current = nullptr;
+			return current;
+		}
+	};
+
+	/// @brief ¼򣬴 nullptr ʾͣ¼
+	class ChangeRecordScope
+	{
+	public:
+		explicit ChangeRecordScope(ChangeSet* target)
+			: mPrevious(std::exchange(ChangeRecorder::Current(), target))
+		{
+		}
+
+		ChangeRecordScope(const ChangeRecordScope&) = delete;
+		ChangeRecordScope& operator=(const ChangeRecordScope&) = delete;
+
+		~ChangeRecordScope() { ChangeRecorder::Current() = mPrevious; }
+
+	private:
+		ChangeSet* mPrevious;
+	};
+
+	// ֵڶ϶ռõַֽvector 
+	template <typename _Ty, typename = void>
+	struct HasContiguousCapacity : std::false_type {};
+
+	template <typename _Ty>
+	struct HasContiguousCapacity<_Ty,
+		std::void_t<decltype(std::declval<const _Ty&>().capacity()), typename _Ty::value_type>>
+		: std::true_type {};
+
+	template <typename _Ty>
+	size_t EstimateHeapSize(const _Ty& value)
+	{
+		if constexpr (HasContiguousCapacity<_Ty>::value)
+			return value.capacity() * sizeof(typename _Ty::value_type);
+		else
+			return 0;
+	}
+
+	/// @brief BindableProperty ĵαֻǰֵ
+	template <typename _Ty>
+	class PropertyChange : public IUndoableChange
+	{
+	public:
+		PropertyChange(std::weak_ptr<BindableProperty<_Ty>*> property, _Ty oldValue)
+			: mProperty(std::move(property)), mOldValue(std::move(oldValue))
+		{
+		}
+
+		void SetNewValue(const _Ty& newValue) { mNewValue = newValue; }
+
+		// ʱ
+		void Undo() override
+		{
+			if (auto property = mProperty.lock())
+				(*property)->SetValue(mOldValue);
+		}
+
+		void Redo() override
+		{
+			if (auto property = mProperty.lock())
+				(*property)->SetValue(*mNewValue);
+		}
+
+		size_t GetSize() const override
+		{
+			return sizeof(*this) + EstimateHeapSize(mOldValue) + (mNewValue ? EstimateHeapSize(*mNewValue) : 0);
+		}
+
+	private:
+		std::weak_ptr<BindableProperty<_Ty>*> mProperty;
+		_Ty mOldValue;
+		std::optional<_Ty> mNewValue;
+	};
+
+	/// @brief Իصʽ¼ı BindableProperty ֮״̬
+	class CallbackChange : public IUndoableChange
+	{
+	public:
+		CallbackChange(std::function<void()> undo, std::function<void()> redo, size_t size)
+			: mUndo(std::move(undo)), mRedo(std::move(redo)), mSize(size)
+		{
+		}
+
+		void Undo() override { mUndo(); }
+		void Redo() override { mRedo(); }
+		size_t GetSize() const override { return sizeof(*this) + mSize; }
+
+	private:
+		std::function<void()> mUndo;
+		std::function<void()> mRedo;
+		size_t mSize;
+	};
+
+	// ================ ӿ ================
+
+	// עӿ
+	class IUnRegister
+	{
+	public:
+		virtual ~IUnRegister() = default;
+		virtual void UnRegister() = 0;
+	};
+
+	class UnRegisterTrigger
+	{
+	public:
+		virtual ~UnRegisterTrigger() { this->UnRegister(); }
+
+		void AddUnRegister(std::shared_ptr<IUnRegister> unRegister)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			mUnRegisters.push_back(std::move(unRegister));
+		}
+
+		void UnRegister()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (auto& unRegister : mUnRegisters)
+			{
+				unRegister->UnRegister();
+			}
+			mUnRegisters.clear();
+		}
+
+	protected:
+		FrameworkMutex mMutex { "UnRegisterTrigger::mMutex" };
+		std::vector<std::shared_ptr<IUnRegister>> mUnRegisters;
+	};
+
+	/// @brief ۲֪ͨ
+	/// Throttleÿ֪ͨһΣЯֵ
+	/// Debounceֵڼڲٱ仯֪ͨ
+	///  Immediate Ĺ۲ BindableProperty::Tick д뷽ֻ
+	struct NotifyPolicy
+	{
+		enum class Mode
+		{
+			Immediate,
+			Throttle,
+			Debounce
+		};
+
+		Mode mode = Mode::Immediate;
+		std::chrono::steady_clock::duration interval {};
+
+		static NotifyPolicy Immediate() { return {}; }
+
+		static NotifyPolicy Throttle(std::chrono::steady_clock::duration interval)
+		{
+			return { Mode::Throttle, interval };
+		}
+
+		static NotifyPolicy Debounce(std::chrono::steady_clock::duration interval)
+		{
+			return { Mode::Debounce, interval };
+		}
+	};
+
+	template <typename _Ty>
+	class BindablePropertyUnRegister
+		: public IUnRegister,
+		public std::enable_shared_from_this<BindablePropertyUnRegister<_Ty>>
+	{
+	public:
+		BindablePropertyUnRegister(int id,
+			BindableProperty<_Ty>* property,
+			std::function<void(const _Ty&)> callback,
+			NotifyPolicy policy = {},
+			Dispatcher* dispatcher = nullptr)
+			: mProperty(property)
+			, mCallback(std::move(callback))
+			, mId(id)
+			, mPolicy(policy)
+			, mDispatcher(dispatcher)
+		{
+		}
+		void UnRegisterWhenObjectDestroyed(UnRegisterTrigger* unRegisterTrigger)
+		{
+			unRegisterTrigger->AddUnRegister(this->shared_from_this());
+		}
+		int GetId() const { return mId; }
+
+		void SetProperty(BindableProperty<_Ty>* property)
+		{
+			mProperty = property;
+		}
+
+		void UnRegister() override
+		{
+			mActive = false;
+			if (mProperty)
+			{
+				mProperty->UnRegister(mId);
+				mProperty = nullptr; // ֹظ
+			}
+		}
+
+		// ʱã֮Ͷκ֪ͨ
+		void Detach()
+		{
+			mActive = false;
+			mProperty = nullptr;
+		}
+
+		// Գ֪ͨÿ۲߸һֵ
+		void Invoke(const _Ty& value)
+		{
+			if (mCallback)
+			{
+				JFRAMEWORK_ALLOCATION_SCOPE(None);
+				mCallback(value);
+			}
+		}
+
+		// ޵ʱֱӵãеʱͶݵĿ̣߳ϲΪֵ
+		// ͬһ۲ֻһִе֪ͨ
+		void Notify(const _Ty& value)
+		{
+			if (!mDispatcher)
+			{
+				Invoke(value);
+				return;
+			}
+
+			{
+				std::lock_guard<FrameworkMutex> lock(mPendingMutex);
+				mPendingValue = value;
+				if (mQueued)
+					return;
+				mQueued = true;
+			}
+
+			std::weak_ptr<BindablePropertyUnRegister<_Ty>> weak = this->shared_from_this();
+			mDispatcher->Post([weak]()
+				{
+					if (auto self = weak.lock())
+						self->Deliver();
+				});
+		}
+
+		bool IsImmediate() const { return mPolicy.mode == NotifyPolicy::Mode::Immediate; }
+
+		// д뷽ã¼б仯ʵ֪ͨƳٵ Tick
+		void MarkDirty() { mDirty = true; }
+
+		//  Tick ãرǷӦ֪ͨ
+		bool ShouldNotify(std::chrono::steady_clock::time_point now)
+		{
+			if (mDirty)
+			{
+				mDirty = false;
+				mPending = true;
+				mLastChange = now;
+			}
+			if (!mPending)
+				return false;
+
+			auto since = mPolicy.mode == NotifyPolicy::Mode::Throttle ? mLastNotify : mLastChange;
+			if (now - since < mPolicy.interval)
+				return false;
+
+			mPending = false;
+			mLastNotify = now;
+			return true;
+		}
+
+	protected:
+		int mId;
+
+	private:
+		// ڵִ߳
+		void Deliver()
+		{
+			std::optional<_Ty> value;
+			{
+				std::lock_guard<FrameworkMutex> lock(mPendingMutex);
+				value.swap(mPendingValue);
+				mQueued = false;
+			}
+			if (value && mActive)
+			{
+				Invoke(*value);
+			}
+		}
+
+		BindableProperty<_Ty>* mProperty;
+		std::function<void(const _Ty&)> mCallback;
+		NotifyPolicy mPolicy;
+		Dispatcher* mDispatcher;
+		std::atomic<bool> mActive { true };
+		FrameworkMutex mPendingMutex { "BindablePropertyUnRegister::mPendingMutex" };
+		std::optional<_Ty> mPendingValue;
+		bool mQueued = false;
+		bool mDirty = false;
+		bool mPending = false;
+		std::chrono::steady_clock::time_point mLastChange {};
+		std::chrono::steady_clock::time_point mLastNotify {};
+	};
+
+	/// @brief Ա¼
+	template <typename _Ty>
+	struct PropertyChangeRecord
+	{
+		uint64_t sequence; // ı
+		_Ty oldValue;
+		_Ty newValue;
+		std::chrono::steady_clock::time_point timestamp;
+		std::thread::id threadId; // д߳
+	};
+
+	/// @brief Ա־̶λ
+	/// ṹSetValue ͳ BindableProperty ־дȡDumpøٽټ
+	/// λԤȷ䣬¼ʱֵֵֻֻбύдλܾ׳쳣޸ĲḲǾɼ¼
+	template <typename _Ty>
+	class PropertyJournal
+	{
+	public:
+		explicit PropertyJournal(size_t capacity)
+			: mEntries(capacity > 0 ? capacity : 1)
+		{
+		}
+
+		// дһύıʱɵļ¼
+		void Record(const _Ty& oldValue, const _Ty& newValue)
+		{
+			auto& entry = mEntries[mCursor % mEntries.size()];
+			entry.oldValue = oldValue;
+			entry.newValue = newValue;
+			entry.timestamp = std::chrono::steady_clock::now();
+			entry.threadId = std::this_thread::get_id();
+			entry.sequence = mCursor++;
+		}
+
+		// ʱ˳򣨾ɵ£ǰļ¼
+		std::vector<PropertyChangeRecord<_Ty>> Dump() const
+		{
+			size_t count = mCursor < mEntries.size() ? static_cast<size_t>(mCursor) : mEntries.size();
+			std::vector<PropertyChangeRecord<_Ty>> result;
+			result.reserve(count);
+			for (uint64_t seq = mCursor - count; seq < mCursor; ++seq)
+			{
+				result.push_back(mEntries[seq % mEntries.size()]);
+			}
+			return result;
+		}
+
+		size_t Capacity() const { return mEntries.size(); }
+		uint64_t TotalRecorded() const { return mCursor; }
+
+	private:
+		std::vector<PropertyChangeRecord<_Ty>> mEntries;
+		uint64_t mCursor = 0;
+	};
+
+	// ɹ۲
+	template <typename _Ty>
+	class BindableProperty
+	{
+		friend class IModel;
+
+	public:
+		BindableProperty() = default;
+		// ֹͿֵ
+		BindableProperty(const BindableProperty&) = delete;
+		BindableProperty& operator=(const BindableProperty&) = delete;
+		BindableProperty(BindableProperty&& other) noexcept
+		{
+			std::lock_guard<FrameworkMutex> lock(other.mMutex);
+			mValue = std::move(other.mValue);
+			mObservers = std::move(other.mObservers);
+			mJournal = std::move(other.mJournal);
+			mUndoAnchor = std::move(other.mUndoAnchor);
+			if (mUndoAnchor)
+				*mUndoAnchor = this;
+			mNextId = other.mNextId;
+			// observermPropertyָ
+			for (auto& observer : mObservers)
+			{
+				if (observer)
+					observer->SetProperty(this);
+			}
+			other.mNextId = 0;
+		}
+
+		BindableProperty& operator=(BindableProperty&& other) noexcept
+		{
+			if (this != &other)
+			{
+				std::lock_guard<FrameworkMutex> lock1(mMutex);
+				std::lock_guard<FrameworkMutex> lock2(other.mMutex);
+				mValue = std::move(other.mValue);
+				mObservers = std::move(other.mObservers);
+				mJournal = std::move(other.mJournal);
+				mUndoAnchor = std::move(other.mUndoAnchor);
+				if (mUndoAnchor)
+					*mUndoAnchor = this;
+				mNextId = other.mNextId;
+				for (auto& observer : mObservers)
+				{
+					if (observer)
+						observer->SetProperty(this);
+				}
+				other.mNextId = 0;
+			}
+			return *this;
+		}
+		explicit BindableProperty(const _Ty& value)
+			: mValue(value)
+		{
+		}
+
+		explicit BindableProperty(_Ty&& value)
+			: mValue(std::move(value))
+		{
+		}
+
+		~BindableProperty()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (auto& observer : mObservers)
+			{
+				observer->Detach();
+			}
+			mObservers.clear();
+		}
+
+		// ȡǰֵ
+		const _Ty& GetValue() const { return mValue; }
+
+		// ֵ
+		void SetValue(const _Ty& newValue)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(PropertySet);
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (mValue == newValue)
+				return;
+			AssignValue(newValue);
+			NotifyObservers();
+		}
+
+		// ֵƶ壬⿽
+		void SetValue(_Ty&& newValue)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(PropertySet);
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (mValue == newValue)
+				return;
+			AssignValue(std::move(newValue));
+			NotifyObservers();
+		}
+
+		// ԭ޸ֵʱ
+		// fn ǩΪ void(_Ty&)  bool(_Ty&) false ʾδ޸ġ֪ͨ
+		// ־ڿɳʱȿֵfn ׳쳣ֵָ false ʵʸĶֵ԰ύ
+		// δֵʱ޷жǷĶʱ׳쳣򷵻 false ᱣصص Model İ汾
+		template <typename _Fn>
+		void Modify(_Fn&& fn)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(PropertySet);
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto change = BeginChange();
+			if (change.NeedsOldValue())
+				change.oldValue.emplace(mValue);
+			bool modified = true;
+			try
+			{
+				if constexpr (std::is_same_v<std::invoke_result_t<_Fn, _Ty&>, bool>)
+					modified = std::forward<_Fn>(fn)(mValue);
+				else
+					std::forward<_Fn>(fn)(mValue);
+			}
+			catch (...)
+			{
+				if (change.oldValue)
+					mValue = std::move(*change.oldValue);
+				else if (mOwner)
+					IncrementModelVersion(mOwner);
+				throw;
+			}
+			if (!modified)
+			{
+				if (!change.oldValue)
+				{
+					if (mOwner)
+						IncrementModelVersion(mOwner);
+					return;
+				}
+				if (mValue == *change.oldValue)
+					return;
+			}
+			CommitChange(change);
+			NotifyObservers();
+		}
+
+		// ֪ͨ
+		void SetValueWithoutEvent(const _Ty& newValue)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			AssignValue(newValue);
+		}
+
+		void SetValueWithoutEvent(_Ty&& newValue)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			AssignValue(std::move(newValue));
+		}
+
+		// ñ־ capacity ¼
+		void EnableJournal(size_t capacity)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			mJournal = std::make_unique<PropertyJournal<_Ty>>(capacity);
+		}
+
+		void DisableJournal()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			mJournal.reset();
+		}
+
+		bool IsJournalEnabled() const
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			return mJournal != nullptr;
+		}
+
+		// ־ɵ£δʱؿ
+		std::vector<PropertyChangeRecord<_Ty>> DumpJournal()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (!mJournal)
+				return {};
+			return mJournal->Dump();
+		}
+
+		// ע۲ߣʼֵ֪ͨ
+		std::shared_ptr<BindablePropertyUnRegister<_Ty>> RegisterWithInitValue(
+			std::function<void(const _Ty&)> onValueChanged,
+			NotifyPolicy policy = {})
+		{
+			onValueChanged(mValue);
+			return Register(std::move(onValueChanged), policy);
+		}
+
+		// ע۲ߣָ/
+		std::shared_ptr<BindablePropertyUnRegister<_Ty>> Register(
+			std::function<void(const _Ty&)> onValueChanged,
+			NotifyPolicy policy = {})
+		{
+			return Register(std::move(onValueChanged), nullptr, policy);
+		}
+
+		// ע̹߳۲ߣ֪ͨͶݵ dispatcher߳ Pump ʱִ
+		// dispatcher עϵ
+		std::shared_ptr<BindablePropertyUnRegister<_Ty>> Register(
+			std::function<void(const _Ty&)> onValueChanged,
+			Dispatcher* dispatcher,
+			NotifyPolicy policy = {})
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(PropertyRegister);
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto unRegister = std::make_shared<BindablePropertyUnRegister<_Ty>>(
+				mNextId++, this, std::move(onValueChanged), policy, dispatcher);
+			mObservers.push_back(unRegister);
+			return unRegister;
+		}
+
+		// /۲ߣ֡ѭʱڵ
+		void Tick(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (auto& observer : mObservers)
+			{
+				if (observer->IsImmediate() || !observer->ShouldNotify(now))
+					continue;
+				JFRAMEWORK_TRACE_SCOPE("property", typeid(BindableProperty).name());
+				try
+				{
+					observer->Notify(mValue);
+				}
+				catch (const std::exception&)
+				{
+				}
+			}
+		}
+
+		// ע۲
+		void UnRegister(int id)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (size_t i = 0; i < mObservers.size(); i++)
+			{
+				auto& observer = mObservers[i];
+				if (observer && observer->GetId() == id)
+				{
+					mObservers.erase(mObservers.begin() + i);
+					break; // ҵע˳ѭ
+				}
+			}
+		}
+
+		// أʹ
+		operator _Ty() const { return mValue; }
+		BindableProperty<_Ty>& operator=(const _Ty& newValue)
+		{
+			SetValue(newValue);
+			return *this;
+		}
+
+		BindableProperty<_Ty>& operator=(_Ty&& newValue)
+		{
+			SetValue(std::move(newValue));
+			return *this;
+		}
+
+	private:
+		struct PendingChange
+		{
+			bool journal = false;
+			bool undo = false;
+			std::optional<_Ty> oldValue; // ύǰ־λ볷¼֮
+
+			bool NeedsOldValue() const { return journal || undo; }
+		};
+
+		// ÷ mMutexδ־Ҳڿɳʱֻжϣֵ
+		PendingChange BeginChange()
+		{
+			PendingChange change;
+			change.journal = mJournal != nullptr;
+			change.undo = ChangeRecorder::IsRecording(mOwner);
+			return change;
+		}
+
+		// ÷ mMutexҪֵʱƳǿ
+		template <typename _Value>
+		void AssignValue(_Value&& newValue)
+		{
+			auto change = BeginChange();
+			if (change.NeedsOldValue())
+			{
+				change.oldValue.emplace(std::move(mValue));
+				try
+				{
+					mValue = std::forward<_Value>(newValue);
+				}
+				catch (...)
+				{
+					mValue = std::move(*change.oldValue);
+					throw;
+				}
+			}
+			else
+			{
+				mValue = std::forward<_Value>(newValue);
+			}
+			CommitChange(change);
+		}
+
+		// ¼ȷϷŹ
+		void CommitChange(PendingChange& change)
+		{
+			if (mOwner)
+				IncrementModelVersion(mOwner);
+			if (!change.oldValue)
+				return;
+			if (change.journal)
+				mJournal->Record(*change.oldValue, mValue);
+			if (change.undo)
+			{
+				if (!mUndoAnchor)
+					mUndoAnchor = std::make_shared<BindableProperty*>(this);
+				auto undo = std::make_unique<PropertyChange<_Ty>>(mUndoAnchor, std::move(*change.oldValue));
+				undo->SetNewValue(mValue);
+				ChangeRecorder::Record(std::move(undo));
+			}
+		}
+
+		// ÷ mMutex
+		void NotifyObservers()
+		{
+			if (mObservers.empty())
+				return;
+			JFRAMEWORK_TRACE_SCOPE("property", typeid(BindableProperty).name());
+			for (auto& observer : mObservers)
+			{
+				if (!observer->IsImmediate())
+				{
+					observer->MarkDirty();
+					continue;
+				}
+				try
+				{
+					observer->Notify(mValue);
+				}
+				catch (const std::exception&)
+				{
+				}
+			}
+		}
+
+		mutable FrameworkMutex mMutex { "BindableProperty::mMutex" };
+		int mNextId = 0;
+		_Ty mValue;
+		std::vector<std::shared_ptr<BindablePropertyUnRegister<_Ty>>> mObservers;
+		std::unique_ptr<PropertyJournal<_Ty>> mJournal;
+		std::shared_ptr<BindableProperty*> mUndoAnchor; // ¼ͨλԣƶ֮
+		IModel* mOwner = nullptr; //  Model IModel::OwnProperty Ǽǣƶʱת
+	};
+
+	// ================ ɹ۲켯 ================
+
+	/// @brief ϱ仯
+	enum class CollectionChangeAction
+	{
+		Insert, // Ԫ
+		Remove, // ƳԪ
+		Update, // 滻Ԫ
+		Move,   // ƶԪأб
+		Reset   // 
+	};
+
+	/// @brief б仯
+	/// value ָ/滻ֵƳľֵڻصڼЧ
+	template <typename _Ty>
+	struct ListChange
+	{
+		CollectionChangeAction action;
+		size_t index;    // 仯λãMove ʱΪԭλ
+		size_t newIndex; //  Move ЧΪĿλ
+		const _Ty* value;
+	};
+
+	/// @brief ֵ仯
+	/// key/value ڻصڼЧReset ʱΪ nullptr
+	template <typename _Key, typename _Val>
+	struct MapChange
+	{
+		CollectionChangeAction action;
+		const _Key* key;
+		const _Val* value;
+	};
+
+	template <typename _Change>
+	class BindableCollectionBase;
+
+	template <typename _Change>
+	class BindableCollectionUnRegister
+		: public IUnRegister,
+		public std::enable_shared_from_this<BindableCollectionUnRegister<_Change>>
+	{
+	public:
+		BindableCollectionUnRegister(int id,
+			BindableCollectionBase<_Change>* collection,
+			std::function<void(const _Change&)> callback)
+			: mId(id)
+			, mCollection(collection)
+			, mCallback(std::move(callback))
+		{
+		}
+
+		void UnRegisterWhenObjectDestroyed(UnRegisterTrigger* unRegisterTrigger)
+		{
+			unRegisterTrigger->AddUnRegister(this->shared_from_this());
+		}
+
+		int GetId() const { return mId; }
+
+		void SetCollection(BindableCollectionBase<_Change>* collection)
+		{
+			mCollection = collection;
+		}
+
+		void UnRegister() override
+		{
+			if (mCollection)
+			{
+				mCollection->UnRegister(mId);
+				mCollection = nullptr;
+			}
+		}
+
+		void Invoke(const _Change& change)
+		{
+			if (mCallback)
+			{
+				mCallback(change);
+			}
+		}
+
+	private:
+		int mId;
+		BindableCollectionBase<_Change>* mCollection;
+		std::function<void(const _Change&)> mCallback;
+	};
+
+	/// @brief ɹ۲켯Ϲ֣۲߹ַ
+	///  IModel::OwnProperty Ǽ Model ÿ޸ĵ汾ɳ¼޸ĵ
+	template <typename _Change>
+	class BindableCollectionBase
+	{
+	public:
+		BindableCollectionBase() = default;
+		// ۲߳мָ룬ֹƶ
+		BindableCollectionBase(const BindableCollectionBase&) = delete;
+		BindableCollectionBase& operator=(const BindableCollectionBase&) = delete;
+
+		~BindableCollectionBase()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (auto& observer : mObservers)
+			{
+				observer->SetCollection(nullptr);
+			}
+			mObservers.clear();
+		}
+
+		// ע۲
+		std::shared_ptr<BindableCollectionUnRegister<_Change>> Register(
+			std::function<void(const _Change&)> onChanged)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto unRegister = std::make_shared<BindableCollectionUnRegister<_Change>>(
+				mNextId++, this, std::move(onChanged));
+			mObservers.push_back(unRegister);
+			return unRegister;
+		}
+
+		// ע۲
+		void UnRegister(int id)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			for (size_t i = 0; i < mObservers.size(); i++)
+			{
+				if (mObservers[i]->GetId() == id)
+				{
+					mObservers.erase(mObservers.begin() + i);
+					break;
+				}
+			}
+		}
+
+	protected:
+		// ÷ mMutex
+		void Notify(const _Change& change)
+		{
+			for (auto& observer : mObservers)
+			{
+				try
+				{
+					observer->Invoke(change);
+				}
+				catch (const std::exception&)
+				{
+				}
+			}
+		}
+
+		// ÷ mMutex޸ɺã Model İ汾ַ
+		void CommitChange(const _Change& change)
+		{
+			if (mOwner)
+				IncrementModelVersion(mOwner);
+			Notify(change);
+		}
+
+		// ÷ mMutex޸ǰжǷҪֵ
+		bool IsRecordingUndo() const { return ChangeRecorder::IsRecording(mOwner); }
+
+		// ÷ mMutexundo/redo ͨϵĹӿطţٺ
+		template <typename _Self, typename _Undo, typename _Redo>
+		void RecordUndo(_Self& self, _Undo undo, _Redo redo, size_t size)
+		{
+			if (!mUndoAnchor)
+				mUndoAnchor = std::make_shared<char>();
+			std::weak_ptr<void> anchor = mUndoAnchor;
+			ChangeRecorder::Record(std::make_unique<CallbackChange>(
+				[anchor, target = &self, undo = std::move(undo)]
+				{
+					if (anchor.lock())
+						undo(*target);
+				},
+				[anchor, target = &self, redo = std::move(redo)]
+				{
+					if (anchor.lock())
+						redo(*target);
+				},
+				size));
+		}
+
+		FrameworkMutex mMutex { "BindableCollectionBase::mMutex" };
+
+	private:
+		friend class IModel;
+
+		int mNextId = 0;
+		std::vector<std::shared_ptr<BindableCollectionUnRegister<_Change>>> mObservers;
+		IModel* mOwner = nullptr; //  Model IModel::OwnProperty Ǽ
+		std::shared_ptr<void> mUndoAnchor; // ¼
+	};
+
+	/// @brief ɹ۲бԪر仯ַֻ O(1) 
+	/// Ԫؿɿʱż¼
+	template <typename _Ty>
+	class BindableList : public BindableCollectionBase<ListChange<_Ty>>
+	{
+		using Base = BindableCollectionBase<ListChange<_Ty>>;
+		using Base::mMutex;
+		using Base::CommitChange;
+
+	public:
+		using ChangeType = ListChange<_Ty>;
+
+		BindableList() = default;
+
+		size_t Size() const { return mItems.size(); }
+		bool Empty() const { return mItems.empty(); }
+		const _Ty& Get(size_t index) const { return mItems.at(index); }
+		const _Ty& operator[](size_t index) const { return mItems[index]; }
+		const std::vector<_Ty>& GetValues() const { return mItems; }
+		auto begin() const { return mItems.begin(); }
+		auto end() const { return mItems.end(); }
+
+		void Add(_Ty value)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			mItems.push_back(std::move(value));
+			RecordInsert(mItems.size() - 1);
+			CommitChange({ CollectionChangeAction::Insert, mItems.size() - 1, 0, &mItems.back() });
+		}
+
+		void Insert(size_t index, _Ty value)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (index > mItems.size())
+				throw std::out_of_range("BindableList::Insert index out of range");
+			auto it = mItems.insert(mItems.begin() + index, std::move(value));
+			RecordInsert(index);
+			CommitChange({ CollectionChangeAction::Insert, index, 0, &*it });
+		}
+
+		void Set(size_t index, _Ty value)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto& item = mItems.at(index);
+			auto old = SaveForUndo(item);
+			item = std::move(value);
+			RecordUpdate(index, old);
+			CommitChange({ CollectionChangeAction::Update, index, 0, &item });
+		}
+
+		// ԭ޸ָԪ
+		template <typename _Fn>
+		void Modify(size_t index, _Fn&& fn)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto& item = mItems.at(index);
+			auto old = SaveForUndo(item);
+			std::forward<_Fn>(fn)(item);
+			RecordUpdate(index, old);
+			CommitChange({ CollectionChangeAction::Update, index, 0, &item });
+		}
+
+		void RemoveAt(size_t index)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (index >= mItems.size())
+				throw std::out_of_range("BindableList::RemoveAt index out of range");
+			// صڼ䱣ֱƳֵЧ
+			_Ty removed = std::move(mItems[index]);
+			mItems.erase(mItems.begin() + index);
+			RecordRemove(index, removed);
+			CommitChange({ CollectionChangeAction::Remove, index, 0, &removed });
+		}
+
+		// Ƴһ value Ԫ
+		bool Remove(const _Ty& value)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto it = std::find(mItems.begin(), mItems.end(), value);
+			if (it == mItems.end())
+				return false;
+			size_t index = static_cast<size_t>(it - mItems.begin());
+			_Ty removed = std::move(*it);
+			mItems.erase(it);
+			RecordRemove(index, removed);
+			CommitChange({ CollectionChangeAction::Remove, index, 0, &removed });
+			return true;
+		}
+
+		void Move(size_t from, size_t to)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if (from >= mItems.size() || to >= mItems.size())
+				throw std::out_of_range("BindableList::Move index out of range");
+			if (from == to)
+				return;
+			if (from < to)
+				std::rotate(mItems.begin() + from, mItems.begin() + from + 1, mItems.begin() + to + 1);
+			else
+				std::rotate(mItems.begin() + to, mItems.begin() + from, mItems.begin() + from + 1);
+			if (this->IsRecordingUndo())
+			{
+				this->RecordUndo(*this,
+					[from, to](BindableList& list) { list.Move(to, from); },
+					[from, to](BindableList& list) { list.Move(from, to); },
+					0);
+			}
+			CommitChange({ CollectionChangeAction::Move, from, to, &mItems[to] });
+		}
+
+		void Clear()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if constexpr (std::is_copy_constructible_v<_Ty>)
+			{
+				if (this->IsRecordingUndo())
+				{
+					size_t size = mItems.capacity() * sizeof(_Ty);
+					this->RecordUndo(*this,
+						[items = mItems](BindableList& list)
+						{
+							for (auto& item : items)
+								list.Add(item);
+						},
+						[](BindableList& list) { list.Clear(); },
+						size);
+				}
+			}
+			mItems.clear();
+			CommitChange({ CollectionChangeAction::Reset, 0, 0, nullptr });
+		}
+
+	private:
+		// µ÷ mMutex
+		std::optional<_Ty> SaveForUndo(const _Ty& item) const
+		{
+			if constexpr (std::is_copy_constructible_v<_Ty>)
+			{
+				if (this->IsRecordingUndo())
+					return item;
+			}
+			return std::nullopt;
+		}
+
+		void RecordInsert(size_t index)
+		{
+			if constexpr (std::is_copy_constructible_v<_Ty>)
+			{
+				if (!this->IsRecordingUndo())
+					return;
+				const _Ty& value = mItems[index];
+				this->RecordUndo(*this,
+					[index](BindableList& list) { list.RemoveAt(index); },
+					[index, value](BindableList& list) { list.Insert(index, value); },
+					sizeof(_Ty) + EstimateHeapSize(value));
+			}
+		}
+
+		void RecordRemove(size_t index, const _Ty& removed)
+		{
+			if constexpr (std::is_copy_constructible_v<_Ty>)
+			{
+				if (!this->IsRecordingUndo())
+					return;
+				this->RecordUndo(*this,
+					[index, removed](BindableList& list) { list.Insert(index, removed); },
+					[index](BindableList& list) { list.RemoveAt(index); },
+					sizeof(_Ty) + EstimateHeapSize(removed));
+			}
+		}
+
+		void RecordUpdate(size_t index, std::optional<_Ty>& old)
+		{
+			if constexpr (std::is_copy_constructible_v<_Ty>)
+			{
+				if (!old)
+					return;
+				const _Ty& value = mItems[index];
+				size_t size = 2 * sizeof(_Ty) + EstimateHeapSize(*old) + EstimateHeapSize(value);
+				this->RecordUndo(*this,
+					[index, previous = std::move(*old)](BindableList& list) { list.Set(index, previous); },
+					[index, value](BindableList& list) { list.Set(index, value); },
+					size);
+			}
+		}
+
+		std::vector<_Ty> mItems;
+	};
+
+	/// @brief ɹ۲ֵ䣬ַ
+	/// ֵɿʱż¼
+	template <typename _Key, typename _Val>
+	class BindableMap : public BindableCollectionBase<MapChange<_Key, _Val>>
+	{
+		using Base = BindableCollectionBase<MapChange<_Key, _Val>>;
+		using Base::mMutex;
+		using Base::CommitChange;
+
+		static constexpr bool Copyable = std::is_copy_constructible_v<_Key> && std::is_copy_constructible_v<_Val>;
+
+	public:
+		using ChangeType = MapChange<_Key, _Val>;
+
+		BindableMap() = default;
+
+		size_t Size() const { return mItems.size(); }
+		bool Empty() const { return mItems.empty(); }
+		bool Contains(const _Key& key) const { return mItems.find(key) != mItems.end(); }
+		const _Val& Get(const _Key& key) const { return mItems.at(key); }
+		const std::unordered_map<_Key, _Val>& GetValues() const { return mItems; }
+
+		// ڷ nullptr
+		const _Val* Find(const _Key& key) const
+		{
+			auto it = mItems.find(key);
+			return it != mItems.end() ? &it->second : nullptr;
+		}
+
+		// 滻
+		void Set(const _Key& key, _Val value)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			std::optional<_Val> old;
+			bool recording = false;
+			if constexpr (Copyable)
+			{
+				recording = this->IsRecordingUndo();
+				auto it = recording ? mItems.find(key) : mItems.end();
+				if (it != mItems.end())
+					old = it->second;
+			}
+			auto result = mItems.insert_or_assign(key, std::move(value));
+			if (recording)
+				RecordUpdate(key, old, result.first->second);
+			auto action = result.second ? CollectionChangeAction::Insert : CollectionChangeAction::Update;
+			CommitChange({ action, &result.first->first, &result.first->second });
+		}
+
+		// ԭ޸Ԫ
+		template <typename _Fn>
+		void Modify(const _Key& key, _Fn&& fn)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto it = mItems.find(key);
+			if (it == mItems.end())
+				throw std::out_of_range("BindableMap::Modify key not found");
+			std::optional<_Val> old;
+			if constexpr (Copyable)
+			{
+				if (this->IsRecordingUndo())
+					old = it->second;
+			}
+			std::forward<_Fn>(fn)(it->second);
+			if (old)
+				RecordUpdate(key, old, it->second);
+			CommitChange({ CollectionChangeAction::Update, &it->first, &it->second });
+		}
+
+		bool Remove(const _Key& key)
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			auto node = mItems.extract(key);
+			if (node.empty())
+				return false;
+			if constexpr (Copyable)
+			{
+				if (this->IsRecordingUndo())
+				{
+					this->RecordUndo(*this,
+						[key = node.key(), value = node.mapped()](BindableMap& map) { map.Set(key, value); },
+						[key = node.key()](BindableMap& map) { map.Remove(key); },
+						sizeof(_Key) + sizeof(_Val) + EstimateHeapSize(node.key()) + EstimateHeapSize(node.mapped()));
+				}
+			}
+			// node бƳļֵصڼ䱣Ч
+			CommitChange({ CollectionChangeAction::Remove, &node.key(), &node.mapped() });
+			return true;
+		}
+
+		void Clear()
+		{
+			std::lock_guard<FrameworkMutex> lock(mMutex);
+			if constexpr (Copyable)
+			{
+				if (this->IsRecordingUndo())
+				{
+					size_t size = mItems.size() * (sizeof(_Key) + sizeof(_Val));
+					this->RecordUndo(*this,
+						[items = mItems](BindableMap& map)
+						{
+							for (auto& [key, value] : items)
+								map.Set(key, value);
+						},
+						[](BindableMap& map) { map.Clear(); },
+						size);
+				}
+			}
+			mItems.clear();
+			CommitChange({ CollectionChangeAction::Reset, nullptr, nullptr });
+		}
+
+	private:
+		// ÷ mMutexold Ϊձʾ޸ǰڸü
+		void RecordUpdate(const _Key& key, std::optional<_Val>& old, const _Val& value)
+		{
+			if constexpr (Copyable)
+			{
+				size_t size = sizeof(_Key) + 2 * sizeof(_Val) + EstimateHeapSize(key) + EstimateHeapSize(value);
+				this->RecordUndo(*this,
+					[key, previous = std::move(old)](BindableMap& map)
+					{
+						if (previous)
+							map.Set(key, *previous);
+						else
+							map.Remove(key);
+					},
+					[key, value](BindableMap& map) { map.Set(key, value); },
+					size);
+			}
+		}
+
+		std::unordered_map<_Key, _Val> mItems;
+	};
+
+	/// @brief ʼӿ
+	class ICanInit
+	{
+	public:
+		bool IsInitialized() const { return mInitialized; }
+		void SetInitialized(bool initialized) { mInitialized = initialized; }
+		virtual ~ICanInit() = default;
+		virtual void Init() = 0;
+		virtual void Deinit() = 0;
+
+	protected:
+		bool mInitialized = false;
+	};
+
+	/// @brief ʼܹʱе
+	/// Էӵоʱֻһָ룻 weak_ptr ʱ shared_ptr ֤ڼ
+	class ArchitectureRef
+	{
+	public:
+		explicit ArchitectureRef(IArchitecture* handle)
+			: mArchitecture(handle)
+		{
+		}
+
+		explicit ArchitectureRef(std::shared_ptr<IArchitecture> owner)
+			: mArchitecture(owner.get()), mOwner(std::move(owner))
+		{
+		}
+
+		IArchitecture* operator->() const { return mArchitecture; }
+		IArchitecture* Get() const { return mArchitecture; }
+		explicit operator bool() const { return mArchitecture != nullptr; }
+
+	private:
+		IArchitecture* mArchitecture;
+		std::shared_ptr<IArchitecture> mOwner;
+	};
+
+	/// @brief ܹӿ
+	class IBelongToArchitecture
+	{
+	public:
+		virtual ~IBelongToArchitecture() = default;
+		virtual std::weak_ptr<IArchitecture> GetArchitecture() const = 0;
+
+		// ӵеļܹɼܹ֤ڵطǿ
+		virtual IArchitecture* GetArchitectureHandle() const { return nullptr; }
+
+	protected:
+		// оʱֱʹãüԭӲΪ weak_ptr
+		ArchitectureRef AcquireArchitecture() const
+		{
+			if (auto* handle = GetArchitectureHandle())
+			{
+				return ArchitectureRef(handle);
+			}
+			return ArchitectureRef(GetArchitecture().lock());
+		}
+	};
+
+	/// @brief ܹýӿ
+	class ICanSetArchitecture
+	{
+	public:
+		virtual ~ICanSetArchitecture() = default;
+		virtual void SetArchitecture(std::shared_ptr<IArchitecture> architecture) = 0;
+
+		// ÷ӵо÷֤Чڼܹnullptr ʾ
+		// ĬϻΪӵʽ SetArchitecture
+		virtual void SetArchitectureHandle(IArchitecture* architecture)
+		{
+			if (architecture)
+			{
+				SetArchitecture(architecture->GetSharedFromThis());
+			}
+		}
+	};
+
+	/// @brief Ϊ÷ӵо뿪ʱ
+	class ArchitectureHandleScope
+	{
+	public:
+		ArchitectureHandleScope(ICanSetArchitecture& component, IArchitecture* architecture)
+			: mComponent(component)
+		{
+			mComponent.SetArchitectureHandle(architecture);
+		}
+
+		ArchitectureHandleScope(const ArchitectureHandleScope&) = delete;
+		ArchitectureHandleScope& operator=(const ArchitectureHandleScope&) = delete;
+
+		~ArchitectureHandleScope() { mComponent.SetArchitectureHandle(nullptr); }
+
+	private:
+		ICanSetArchitecture& mComponent;
+	};
+
+	// ================ ܽӿ ================
+
+	/// @brief ȡModel
+	class ICanGetModel : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetModel()
+		{
+			static_assert(std::is_base_of_v<IModel, _Ty>,
+				"_Ty must inherit from IModel");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto model = arch->GetModel<_Ty>();
+			return model;
+		}
+
+		// ӵе Model ã Model עڼܹڼЧ
+		// мܹʱüԭӲ
+		template <typename _Ty>
+		_Ty& GetModelRef()
+		{
+			static_assert(std::is_base_of_v<IModel, _Ty>,
+				"_Ty must inherit from IModel");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->GetModelRef<_Ty>();
+		}
+	};
+
+	/// @brief ȡSystem
+	class ICanGetSystem : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetSystem()
+		{
+			static_assert(std::is_base_of_v<ISystem, _Ty>,
+				"_Ty must inherit from ISystem");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto system = arch->GetSystem<_Ty>();
+			return system;
+		}
+
+		// ӵе System ã System עڼܹڼЧͬ GetModelRef
+		template <typename _Ty>
+		_Ty& GetSystemRef()
+		{
+			static_assert(std::is_base_of_v<ISystem, _Ty>,
+				"_Ty must inherit from ISystem");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->GetSystemRef<_Ty>();
+		}
+	};
+
+	/// @brief Command
+	class ICanSendCommand : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty, typename... Args>
+		void SendCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from IJCommand");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			arch->SendCommand<_Ty>(std::forward<Args>(args)...);
+		}
+
+		void SendCommand(std::unique_ptr<IJCommand> command)
+		{
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(command).name());
+			}
+			arch->SendCommand(std::move(command));
+		}
+
+		template <typename _Ty, typename... Args>
+		std::future<void> SendCommandAsync(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from IJCommand");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->SendCommandAsync<_Ty>(std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		void EnqueueCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from IJCommand");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			arch->EnqueueCommand<_Ty>(std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		void PostCommand(Dispatcher& dispatcher, Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty>,
+				"_Ty must inherit from IJCommand");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			arch->PostCommand<_Ty>(dispatcher, std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> EnqueueCommandAfter(std::chrono::nanoseconds delay, Args&&... args)
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->EnqueueCommandAfter<_Ty>(delay, std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> EnqueueCommandEvery(std::chrono::nanoseconds period, Args&&... args)
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->EnqueueCommandEvery<_Ty>(period, std::forward<Args>(args)...);
+		}
+
+#if JFRAMEWORK_HAS_COROUTINES
+		template <typename _Ty, typename... Args>
+		std::future<void> SendCoroutineCommand(Args&&... args)
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->SendCoroutineCommand<_Ty>(std::forward<Args>(args)...);
+		}
+#endif
+	};
+
+	/// @brief Command
+	class ICanSendQuery : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty, typename... Args>
+		auto SendQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto result = arch->SendQuery<_Ty>(std::forward<Args>(args)...);
+			return result;
+		}
+
+		template <typename _Ty>
+		auto SendQuery(std::unique_ptr<_Ty> query)
+			-> decltype(std::declval<_Ty>().Do())
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto result = arch->SendQuery(std::move(query));
+			return result;
+		}
+
+		template <typename _Ty, typename... Args>
+		auto SendCachedQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			return arch->SendCachedQuery<_Ty>(std::forward<Args>(args)...);
+		}
+
+		template <typename... _Queries>
+		auto SendQueries(std::unique_ptr<_Queries>... queries)
+			-> std::tuple<decltype(std::declval<_Queries>().Do())...>
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException("SendQueries");
+			}
+
+			return arch->SendQueries(std::move(queries)...);
+		}
+
+#if JFRAMEWORK_HAS_COROUTINES
+		template <typename _Ty, typename... Args>
+		auto SendCoroutineQuery(Args&&... args)
+			-> std::future<typename decltype(std::declval<_Ty>().DoAsync())::value_type>
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->SendCoroutineQuery<_Ty>(std::forward<Args>(args)...);
+		}
+#endif
+	};
+
+	class ICanGetUtility : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty>
+		std::shared_ptr<_Ty> GetUtility()
+		{
+			static_assert(std::is_base_of_v<IUtility, _Ty>,
+				"_Ty must inherit from IUtility");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto utility = arch->GetUtility<_Ty>();
+			return utility;
+		}
+
+		JobSystem& GetJobSystem()
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException("JobSystem");
+			}
+			return arch->GetJobSystem();
+		}
+	};
+
+	// ================ ¼עӿ ================
+
+	/// @brief Event
+	class ICanSendEvent : public IBelongToArchitecture
+	{
+	public:
+		template <typename _Ty, typename... Args>
+		void SendEvent(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			arch->SendEvent<_Ty>(std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> SendEventAfter(std::chrono::nanoseconds delay, Args&&... args)
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->SendEventAfter<_Ty>(delay, std::forward<Args>(args)...);
+		}
+
+		template <typename _Ty, typename... Args>
+		std::shared_ptr<TimerToken> SendEventEvery(std::chrono::nanoseconds period, Args&&... args)
+		{
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+			return arch->SendEventEvery<_Ty>(period, std::forward<Args>(args)...);
+		}
+	};
+
+	/// @brief ע/ע¼
+	class ICanRegisterEvent : public IBelongToArchitecture
+	{
+	public:
+		virtual ~ICanRegisterEvent() = default;
+
+		template <typename _Ty>
+		void RegisterEvent(ICanHandleEvent* handler)
+		{
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			arch->RegisterEvent<_Ty>(handler);
+		}
+
+		template <typename _Ty>
+		void UnRegisterEvent(ICanHandleEvent* handler)
+		{
+			static_assert(std::is_base_of_v<IEvent, _Ty>,
+				"_Ty must inherit from IEvent");
+
+			auto arch = AcquireArchitecture();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			arch->UnRegisterEvent<_Ty>(handler);
+		}
+	};
+
+	// ================ ӿ ================
+
+	/// @brief ӿ
+	class IJCommand : public ICanSetArchitecture,
+		public ICanGetSystem,
+		public ICanGetModel,
+		public ICanSendCommand,
+		public ICanSendEvent,
+		public ICanSendQuery,
+		public ICanGetUtility
+	{
+	public:
+		virtual ~IJCommand() override = default;
+		virtual void Execute() = 0;
+
+		// 첽ִʱͬ˳ִ
+		// Ĭ typeid(void) ʾ˳Ҫ󣬿
+		virtual std::type_index GetOrderingKey() const { return typeid(void); }
+
+		// д Modelִǰȡöд Model Ķд false ʾ
+		virtual bool DeclareModelAccess(ModelAccess& /*access*/) const { return false; }
+	};
+
+	/// @brief д־
+	///  IJCommand һ̳У־ Architecture::RegisterJournaledCommand עһ
+	/// طʱͨע _Ty::Deserialize(std::string_view) ؽ
+	class ISerializableCommand
+	{
+	public:
+		virtual ~ISerializableCommand() = default;
+		virtual std::string_view GetJournalName() const = 0;
+		virtual void Serialize(std::string& out) const = 0;
+	};
+
+	/// @brief Modelӿ
+	class IModel : public ICanSetArchitecture,
+		public ICanInit,
+		public ICanSendEvent,
+		public ICanSendQuery,
+		public ICanGetUtility,
+		public ICanGetModel
+	{
+	public:
+		// ݰ汾ţڲѯʧЧʱд Model
+		// δдϵʹ Model
+		uint64_t GetVersion() const { return mVersion.load(std::memory_order_acquire); }
+
+		// ֮޸ֶͨκֶãͨ OwnProperty Ǽǵ޸ʱԶ
+		void IncrementVersion() { mVersion.fetch_add(1, std::memory_order_acq_rel); }
+
+		// öдȡ Model /ѯִУдĶռִ
+		// ڲʿʼǰãڹ캯 OnInit 
+		void EnableAccessGuard()
+		{
+			if (!mAccessGuard)
+				mAccessGuard = std::make_unique<std::shared_mutex>();
+		}
+
+		std::shared_mutex* GetAccessGuard() const { return mAccessGuard.get(); }
+
+	protected:
+		// ǼǴ Model е BindablePropertyBindableList  BindableMapÿ޸Ķ Model İ汾
+		// ֮дͬʹѯʧЧɳֻ¼ѵǼ뼯ϵ޸
+		template <typename... _Ty>
+		void OwnProperty(_Ty&... properties)
+		{
+			((properties.mOwner = this), ...);
+		}
+
+	private:
+		std::atomic<uint64_t> mVersion { 0 };
+		std::unique_ptr<std::shared_mutex> mAccessGuard;
+	};
+
+	/// @brief Systemӿ
+	class ISystem : public ICanSetArchitecture,
+		public ICanInit,
+		public ICanGetModel,
+		public ICanHandleEvent,
+		public ICanGetSystem,
+		public ICanRegisterEvent,
+		public ICanSendEvent,
+		public ICanSendQuery,
+		public ICanGetUtility
+	{
+	public:
+		// ÿ֡£ Architecture::Tick 
+		virtual void Update(float /*deltaTime*/) {}
+
+		// ÿ֡¶д Model false ʾÿ֡
+		virtual bool DeclareUpdate(ModelAccess& /*access*/) { return false; }
+	};
+
+	// @brief Controllerӿ
+	class IController : public ICanGetSystem,
+		public ICanGetModel,
+		public ICanSendCommand,
+		public ICanSendEvent,
+		public ICanHandleEvent,
+		public ICanRegisterEvent,
+		public ICanSendQuery,
+		public ICanGetUtility
+	{
+	};
+
+	/// @brief Queryӿ
+	template <typename _Ty>
+	class IQuery : public ICanSetArchitecture,
+		public ICanGetModel,
+		public ICanGetSystem,
+		public ICanSendQuery
+	{
+	public:
+		virtual ~IQuery() override = default;
+		virtual _Ty Do() = 0;
+
+		// ֻѯ޸κ״̬SendQueries ɽֻѯִ
+		virtual bool IsReadOnly() const { return false; }
+
+		// д Modelִǰȡöд Model Ķд false ʾ
+		virtual bool DeclareModelAccess(ModelAccess& /*access*/) const { return false; }
+	};
+
+	class IUtility
+	{
+	public:
+		virtual ~IUtility() = default; // 
+	};
+
+	// ================ Model ׷ ================
+
+	/// @brief ¼ǰ߳/ѯִڼͨ GetModel ʵ Model
+	/// ʱ Model İ汾ţѯԷʱİ汾ΪʧЧ
+	class ModelAccessTracker
+	{
+	public:
+		struct Access
+		{
+			IModel* model;
+			uint64_t version;
+		};
+
+		static void Record(IModel* model)
+		{
+			auto& state = GetState();
+			if (state.depth == 0)
+				return;
+			// ͬһظȡͬһ Model ʱֻ¼һ
+			if (std::any_of(state.log.begin() + state.mark, state.log.end(),
+					[model](const Access& access) { return access.model == model; }))
+				return;
+			state.log.push_back({ model, model->GetVersion() });
+		}
+
+	private:
+		friend class ModelAccessScope;
+
+		struct State
+		{
+			std::vector<Access> log; // ߳ڸãԤȺٷ
+			size_t depth = 0;
+			size_t mark = 0; // ڲʼλ
+		};
+
+		static State& GetState()
+		{
+			thread_local State state;
+			return state;
+		}
+	};
+
+	/// @brief Model ׷򣬿Ƕ
+	class ModelAccessScope
+	{
+	public:
+		// bumpVersionsOnExit Ϊ true ʱ뿪ʹ Model 汾
+		// Ϊ false ʱѯʼ¼뿪ʱ
+		explicit ModelAccessScope(bool bumpVersionsOnExit)
+			: mState(ModelAccessTracker::GetState())
+			, mBegin(mState.log.size())
+			, mPreviousMark(mState.mark)
+			, mBumpVersions(bumpVersionsOnExit)
+		{
+			++mState.depth;
+			mState.mark = mBegin;
+		}
+
+		ModelAccessScope(const ModelAccessScope&) = delete;
+		ModelAccessScope& operator=(const ModelAccessScope&) = delete;
+
+		~ModelAccessScope()
+		{
+			if (mBumpVersions)
+			{
+				if (mHasTargets)
+				{
+					for (auto* model : mTargets)
+						model->IncrementVersion();
+				}
+				else
+				{
+					for (size_t i = mBegin; i < mState.log.size(); ++i)
+						mState.log[i].model->IncrementVersion();
+				}
+				mState.log.resize(mBegin);
+			}
+			else if (mState.depth == 1)
+			{
+				mState.log.resize(mBegin);
+			}
+			else
+			{
+				// Ѽ¼ Model İ汾
+				auto parentEnd = mState.log.begin() + mBegin;
+				auto end = std::remove_if(parentEnd, mState.log.end(), [&](const ModelAccessTracker::Access& access)
+					{
+						return std::any_of(mState.log.begin() + mPreviousMark, parentEnd,
+							[&](const ModelAccessTracker::Access& a) { return a.model == access.model; });
+					});
+				mState.log.erase(end, mState.log.end());
+			}
+			mState.mark = mPreviousMark;
+			--mState.depth;
+		}
+
+		// 뿪ʱֻ Modelд뼯ϣǷʹȫ Model
+		void SetVersionTargets(std::vector<IModel*> models)
+		{
+			mTargets = std::move(models);
+			mHasTargets = true;
+		}
+
+		// ڷʹ Modelȥأ״ηʱİ汾
+		std::vector<ModelAccessTracker::Access> Collect() const
+		{
+			return { mState.log.begin() + mBegin, mState.log.end() };
+		}
+
+	private:
+		ModelAccessTracker::State& mState;
+		size_t mBegin;
+		size_t mPreviousMark;
+		bool mBumpVersions;
+		bool mHasTargets = false;
+		std::vector<IModel*> mTargets;
+	};
+
+	inline void TrackModelAccess(const std::shared_ptr<IModel>& model)
+	{
+		ModelAccessTracker::Record(model.get());
+		ChangeRecorder::AddModel(model);
+	}
+
+	inline bool TrackModelAccess(IModel* model)
+	{
+		if (ChangeRecorder::IsRecording())
+			return false;
+		ModelAccessTracker::Record(model);
+		return true;
+	}
+
+	inline void IncrementModelVersion(IModel* model)
+	{
+		model->IncrementVersion();
+	}
+
+	/// @brief  Model д
+	/// ͻҽһдһд ModelһΪռ
+	class ModelAccess
+	{
+	public:
+		template <typename _Ty>
+		ModelAccess& Read()
+		{
+			static_assert(std::is_base_of_v<IModel, _Ty>, "T must inherit from IModel");
+			AddUnique(mReads, typeid(_Ty));
+			return *this;
+		}
+
+		template <typename _Ty>
+		ModelAccess& Write()
+		{
+			static_assert(std::is_base_of_v<IModel, _Ty>, "T must inherit from IModel");
+			AddUnique(mWrites, typeid(_Ty));
+			return *this;
+		}
+
+		// δĹ״̬κͻ
+		ModelAccess& Exclusive()
+		{
+			mExclusive = true;
+			return *this;
+		}
+
+		bool ConflictsWith(const ModelAccess& other) const
+		{
+			if (mExclusive || other.mExclusive)
+				return true;
+			for (auto& type : mWrites)
+			{
+				if (other.Touches(type))
+					return true;
+			}
+			for (auto& type : other.mWrites)
+			{
+				if (Touches(type))
+					return true;
+			}
+			return false;
+		}
+
+		const std::vector<std::type_index>& GetReads() const { return mReads; }
+		const std::vector<std::type_index>& GetWrites() const { return mWrites; }
+		bool IsExclusive() const { return mExclusive; }
+
+	private:
+		static void AddUnique(std::vector<std::type_index>& types, std::type_index type)
+		{
+			if (std::find(types.begin(), types.end(), type) == types.end())
+				types.push_back(type);
+		}
+
+		bool Touches(std::type_index type) const
+		{
+			return std::find(mReads.begin(), mReads.end(), type) != mReads.end() ||
+				std::find(mWrites.begin(), mWrites.end(), type) != mWrites.end();
+		}
+
+		std::vector<std::type_index> mReads;
+		std::vector<std::type_index> mWrites;
+		bool mExclusive = false;
+	};
+
+	/// @brief Ķдϳ Model д
+	/// ַ˳ȡԱͬһ߳ѳеظȡ
+	/// Ƕ׵/ѯֻ׷ӵַߵ׳ ModelAccessException
+	class ModelAccessGuard
+	{
+	public:
+		ModelAccessGuard() = default;
+		ModelAccessGuard(const ModelAccessGuard&) = delete;
+		ModelAccessGuard& operator=(const ModelAccessGuard&) = delete;
+
+		~ModelAccessGuard() { Release(); }
+
+		// ǰ߳Ƿκ Model д
+		static bool IsHoldingAny() { return !GetHeld().empty(); }
+
+		void Acquire(IArchitecture& architecture, const ModelAccess& access)
+		{
+			std::vector<IModel*> reads;
+			std::vector<IModel*> writes;
+			for (auto& type : access.GetReads())
+			{
+				if (auto model = architecture.GetModel(type))
+					reads.push_back(model.get());
+			}
+			for (auto& type : access.GetWrites())
+			{
+				if (auto model = architecture.GetModel(type))
+					writes.push_back(model.get());
+			}
+			Acquire(reads, writes);
+		}
+
+		void Acquire(const std::vector<IModel*>& reads, const std::vector<IModel*>& writes)
+		{
+			std::vector<Lock> wanted;
+			for (auto* model : reads)
+			{
+				if (auto* mutex = model->GetAccessGuard())
+					wanted.push_back({ mutex, false });
+			}
+			for (auto* model : writes)
+			{
+				if (auto* mutex = model->GetAccessGuard())
+					wanted.push_back({ mutex, true });
+			}
+			if (wanted.empty())
+				return;
+
+			std::sort(wanted.begin(), wanted.end(), [](const Lock& a, const Lock& b)
+				{ return std::less<std::shared_mutex*>()(a.mutex, b.mutex); });
+			// ͬһ Model ͬʱдʱд
+			size_t unique = 0;
+			for (auto& lock : wanted)
+			{
+				if (unique > 0 && wanted[unique - 1].mutex == lock.mutex)
+					wanted[unique - 1].exclusive |= lock.exclusive;
+				else
+					wanted[unique++] = lock;
+			}
+			wanted.resize(unique);
+
+			// Уټʧʱκ
+			auto& held = GetHeld();
+			std::shared_mutex* highest = nullptr;
+			for (auto& lock : held)
+			{
+				if (!highest || std::less<std::shared_mutex*>()(highest, lock.mutex))
+					highest = lock.mutex;
+			}
+			size_t acquire = 0;
+			for (auto& lock : wanted)
+			{
+				auto it = std::find_if(held.begin(), held.end(), [&](const Lock& h) { return h.mutex == lock.mutex; });
+				if (it != held.end())
+				{
+					if (lock.exclusive && !it->exclusive)
+						throw ModelAccessException("cannot upgrade a held read guard to write");
+					lock.mutex = nullptr; // ѳУ
+					continue;
+				}
+				if (highest && std::less<std::shared_mutex*>()(lock.mutex, highest))
+					throw ModelAccessException("nested access must be declared by the outer command or query");
+				++acquire;
+			}
+
+			mBegin = held.size();
+			for (auto& lock : wanted)
+			{
+				if (!lock.mutex)
+					continue;
+				if (lock.exclusive)
+					lock.mutex->lock();
+				else
+					lock.mutex->lock_shared();
+				held.push_back(lock);
+			}
+			mAcquired = acquire;
+		}
+
+		void Release()
+		{
+			if (mAcquired == 0)
+				return;
+			auto& held = GetHeld();
+			for (size_t i = held.size(); i-- > mBegin;)
+			{
+				if (held[i].exclusive)
+					held[i].mutex->unlock();
+				else
+					held[i].mutex->unlock_shared();
+			}
+			held.resize(mBegin);
+			mAcquired = 0;
+		}
+
+	private:
+		struct Lock
+		{
+			std::shared_mutex* mutex;
+			bool exclusive;
+		};
+
+		// ǰ̳߳еȡ˳
+		static std::vector<Lock>& GetHeld()
+		{
+			thread_local std::vector<Lock> held;
+			return held;
+		}
+
+		size_t mBegin = 0;
+		size_t mAcquired = 0;
+	};
+
+	inline bool IsHoldingModelAccess() { return ModelAccessGuard::IsHoldingAny(); }
+
+#if JFRAMEWORK_HAS_COROUTINES
+	// ================ Э ================
+
+	/// @brief Э̷ֵ洢
+	template <typename _Ty>
+	class TaskPromiseResult
+	{
+	public:
+		template <typename _Value>
+		void return_value(_Value&& value)
+		{
+			mValue.emplace(std::forward<_Value>(value));
+		}
+
+		_Ty TakeResult() { return std::move(*mValue); }
+
+	private:
+		std::optional<_Ty> mValue;
+	};
+
+	template <>
+	class TaskPromiseResult<void>
+	{
+	public:
+		void return_void() {}
+		void TakeResult() {}
+	};
+
+	/// @brief Э
+	///  co_await ʱʼִУֱӻָȴԳתƣ쳣 co_await ׳
+	template <typename _Ty = void>
+	class Task
+	{
+	public:
+		using value_type = _Ty;
+
+		struct promise_type;
+
+	private:
+		struct FinalAwaiter
+		{
+			bool await_ready() const noexcept { return false; }
+
+			std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> handle) noexcept
+			{
+				auto continuation = handle.promise().continuation;
+				return continuation ? continuation : std::noop_coroutine();
+			}
+
+			void await_resume() const noexcept {}
+		};
+
+	public:
+		struct promise_type : TaskPromiseResult<_Ty>
+		{
+			std::coroutine_handle<> continuation;
+			std::exception_ptr exception;
+
+			Task get_return_object()
+			{
+				return Task(std::coroutine_handle<promise_type>::from_promise(*this));
+			}
+
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			FinalAwaiter final_suspend() const noexcept { return {}; }
+			void unhandled_exception() { exception = std::current_exception(); }
+		};
+
+		Task(Task&& other) noexcept
+			: mHandle(std::exchange(other.mHandle, {}))
+		{
+		}
+
+		Task& operator=(Task&& other) noexcept
+		{
+			if (this != &other)
+			{
+				if (mHandle)
+					mHandle.destroy();
+				mHandle = std::exchange(other.mHandle, {});
+			}
+			return *this;
+		}
+
+		Task(const Task&) = delete;
+		Task& operator=(const Task&) = delete;
+
+		~Task()
+		{
+			if (mHandle)
+				mHandle.destroy();
+		}
+
+		bool await_ready() const noexcept { return mHandle.done(); }
+
+		std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+		{
+			mHandle.promise().continuation = awaiting;
+			return mHandle;
+		}
+
+		_Ty await_resume()
+		{
+			auto& promise = mHandle.promise();
+			if (promise.exception)
+				std::rethrow_exception(promise.exception);
+			return promise.TakeResult();
+		}
+
+	private:
+		explicit Task(std::coroutine_handle<promise_type> handle)
+			: mHandle(handle)
+		{
+		}
+
+		std::coroutine_handle<promise_type> mHandle;
+	};
+
+	/// @brief Э̵
+	/// δɵĸЭ̣Э̵߳Ǽǣ̵֡߳ Tick ͳһָ
+	/// δɵЭֻռЭ֡ռ̣߳ӳٻָɶʱʱ
+	class CoroutineScheduler
+	{
+	public:
+		explicit CoroutineScheduler(std::shared_ptr<TimerService> timers)
+			: mTimerService(std::move(timers))
+		{
+		}
+
+		CoroutineScheduler(const CoroutineScheduler&) = delete;
+		CoroutineScheduler& operator=(const CoroutineScheduler&) = delete;
+
+		~CoroutineScheduler() { Clear(); }
+
+		// Э̣ڵִ߳еһ
+		void Spawn(Task<void> task)
+		{
+			auto root = MakeRoot(std::move(task));
+			auto& promise = root.promise();
+			promise.scheduler = this;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mRoots.insert(&promise);
+			}
+			root.resume();
+		}
+
+		// һ Tick ʱָ̰߳ȫ
+		void Schedule(std::coroutine_handle<> handle)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mReady.push_back(handle);
+		}
+
+		// ʱںĵһ Tick ʱָ̰߳ȫ
+		void ScheduleAfter(std::chrono::nanoseconds delay, std::coroutine_handle<> handle);
+
+		// ָоЭ̣ػָָڼµǼǵЭһ Tick
+		size_t Tick()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mResuming.swap(mReady);
+			}
+
+			for (auto handle : mResuming)
+			{
+				handle.resume();
+			}
+			size_t count = mResuming.size();
+			mResuming.clear();
+			return count;
+		}
+
+		// δɵĸЭ
+		size_t GetActiveCount()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mRoots.size();
+		}
+
+		// δɵЭ̣ Tickʱ Advance ͬһ̵߳
+		void Clear()
+		{
+			std::unordered_set<RootPromise*> roots;
+			std::unordered_map<uint64_t, Delayed> delayed;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				roots.swap(mRoots);
+				delayed.swap(mDelayed);
+				mReady.clear();
+			}
+			CancelDelayed(delayed);
+
+			for (auto* promise : roots)
+			{
+				promise->scheduler = nullptr;
+				std::coroutine_handle<RootPromise>::from_promise(*promise).destroy();
+			}
+
+			// ǰѵǼǵЭ̾ʧЧʱȴȡ֮󲻻ٵǼ
+			std::lock_guard<std::mutex> lock(mMutex);
+			mReady.clear();
+		}
+
+	private:
+		struct RootPromise;
+
+		// Э̽ٲӵƳ
+		struct Root
+		{
+			using promise_type = RootPromise;
+			std::coroutine_handle<RootPromise> handle;
+
+			RootPromise& promise() { return handle.promise(); }
+			void resume() { handle.resume(); }
+		};
+
+		struct RootPromise
+		{
+			CoroutineScheduler* scheduler = nullptr;
+
+			~RootPromise()
+			{
+				if (scheduler)
+					scheduler->Forget(this);
+			}
+
+			Root get_return_object() { return { std::coroutine_handle<RootPromise>::from_promise(*this) }; }
+			std::suspend_always initial_suspend() const noexcept { return {}; }
+			std::suspend_never final_suspend() const noexcept { return {}; }
+			void return_void() {}
+			void unhandled_exception() {}
+		};
+
+		struct Delayed
+		{
+			std::coroutine_handle<> handle;
+			uint64_t timer; // TimerId
+		};
+
+		static Root MakeRoot(Task<void> task)
+		{
+			co_await std::move(task);
+		}
+
+		void Forget(RootPromise* promise)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRoots.erase(promise);
+		}
+
+		// ʱصЭڵȴʱǼǵһ Tick
+		void Wake(uint64_t sequence)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto it = mDelayed.find(sequence);
+			if (it == mDelayed.end())
+				return;
+			mReady.push_back(it->second.handle);
+			mDelayed.erase(it);
+		}
+
+		void CancelDelayed(const std::unordered_map<uint64_t, Delayed>& delayed);
+
+		std::shared_ptr<TimerService> mTimerService;
+		std::mutex mMutex;
+		std::unordered_set<RootPromise*> mRoots;
+		std::vector<std::coroutine_handle<>> mReady;
+		std::vector<std::coroutine_handle<>> mResuming; //  Tick ̷߳ʣ
+		std::unordered_map<uint64_t, Delayed> mDelayed; // ȴʱЭ̣Ǽ
+		uint64_t mDelaySequence = 0;
+	};
+
+	/// @brief һ Tick ָʱ֮
+	class ResumeAwaiter
+	{
+	public:
+		explicit ResumeAwaiter(CoroutineScheduler& scheduler,
+			std::optional<std::chrono::nanoseconds> delay = std::nullopt)
+			: mScheduler(scheduler), mDelay(delay)
+		{
+		}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			if (mDelay)
+				mScheduler.ScheduleAfter(*mDelay, handle);
+			else
+				mScheduler.Schedule(handle);
+		}
+
+		void await_resume() const noexcept {}
+
+	private:
+		CoroutineScheduler& mScheduler;
+		std::optional<std::chrono::nanoseconds> mDelay;
+	};
+
+	/// @brief ֱյһָ͵¼co_await ĽΪ¼
+	template <typename _Event>
+	class EventAwaiter
+	{
+	public:
+		explicit EventAwaiter(std::weak_ptr<IArchitecture> architecture)
+			: mState(std::make_shared<State>())
+		{
+			mState->architecture = std::move(architecture);
+		}
+
+		EventAwaiter(const EventAwaiter&) = delete;
+		EventAwaiter& operator=(const EventAwaiter&) = delete;
+
+		// Эڵȴڼ䱻ʱע¼ַյ¼ٻָЭ
+		~EventAwaiter()
+		{
+			{
+				std::lock_guard<std::mutex> lock(mState->mutex);
+				mState->cancelled = true;
+			}
+			if (mState->registered.exchange(false))
+			{
+				if (std::shared_ptr<IArchitecture> arch = mState->architecture.lock())
+					arch->UnRegisterEvent<_Event>(mState.get());
+			}
+		}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			std::shared_ptr<IArchitecture> arch = mState->architecture.lock();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Event).name());
+			}
+			mState->scheduler = &arch->GetCoroutineScheduler();
+			mState->handle = handle;
+			mState->registered = true;
+			arch->RegisterEvent<_Event>(std::shared_ptr<ICanHandleEvent>(mState));
+		}
+
+		std::shared_ptr<_Event> await_resume() { return std::move(mState->event); }
+
+	private:
+		// ¼߹ͬУЭָ̻ٵȴ󣬲гٵ HandleEvent ֻῴע
+		struct State : ICanHandleEvent
+		{
+			std::weak_ptr<IArchitecture> architecture;
+			CoroutineScheduler* scheduler = nullptr;
+			std::coroutine_handle<> handle;
+			std::shared_ptr<_Event> event;
+			std::atomic<bool> registered { false };
+			std::mutex mutex;
+			bool cancelled = false;
+
+			void HandleEvent(std::shared_ptr<IEvent> received) override
+			{
+				// ֻյһ¼
+				if (!registered.exchange(false))
+					return;
+				event = std::static_pointer_cast<_Event>(received);
+				if (std::shared_ptr<IArchitecture> arch = architecture.lock())
+					arch->UnRegisterEvent<_Event>(this);
+
+				//  CommandAwaiter ͬЭ֡ʱٵǼ
+				std::lock_guard<std::mutex> lock(mutex);
+				if (!cancelled)
+					scheduler->Schedule(handle);
+			}
+		};
+
+		std::shared_ptr<State> mState;
+	};
+
+	/// @brief ڿִ̳߳ͨɺ Tick ָȴЭ
+	class CommandAwaiter
+	{
+	public:
+		CommandAwaiter(std::weak_ptr<IArchitecture> architecture, std::unique_ptr<IJCommand> command)
+			: mArchitecture(std::move(architecture))
+			, mCommand(std::move(command))
+			, mState(std::make_shared<State>())
+		{
+		}
+
+		CommandAwaiter(const CommandAwaiter&) = delete;
+		CommandAwaiter& operator=(const CommandAwaiter&) = delete;
+
+		// Эڵȴڼ䱻ʱɺٻָ
+		~CommandAwaiter()
+		{
+			std::lock_guard<std::mutex> lock(mState->mutex);
+			mState->cancelled = true;
+		}
+
+		bool await_ready() const noexcept { return false; }
+
+		void await_suspend(std::coroutine_handle<> handle)
+		{
+			auto arch = mArchitecture.lock();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(*mCommand).name());
+			}
+			mState->scheduler = &arch->GetCoroutineScheduler();
+			mState->handle = handle;
+
+			auto key = mCommand->GetOrderingKey();
+			// ִֻڼмܹЭ̲ӳܹ
+			auto task = [arch, command = std::shared_ptr<IJCommand>(std::move(mCommand)), state = mState]()
+			{
+				std::exception_ptr exception;
+				try
+				{
+					arch->ExecuteCommand(*command);
+				}
+				catch (...)
+				{
+					exception = std::current_exception();
+				}
+
+				std::lock_guard<std::mutex> lock(state->mutex);
+				state->exception = exception;
+				if (!state->cancelled)
+					state->scheduler->Schedule(state->handle);
+			};
+
+			if (key == typeid(void))
+				arch->GetTaskExecutor().Post(std::move(task));
+			else
+				arch->GetTaskExecutor().Post(key, std::move(task));
+		}
+
+		void await_resume()
+		{
+			if (mState->exception)
+				std::rethrow_exception(mState->exception);
+		}
+
+	private:
+		struct State
+		{
+			std::mutex mutex;
+			CoroutineScheduler* scheduler = nullptr;
+			std::coroutine_handle<> handle;
+			std::exception_ptr exception;
+			bool cancelled = false;
+		};
+
+		std::weak_ptr<IArchitecture> mArchitecture;
+		std::unique_ptr<IJCommand> mCommand;
+		std::shared_ptr<State> mState;
+	};
+
+	/// @brief Э֡Э/ѯֱִн
+	template <typename _Ty, typename _Result>
+	Task<_Result> RunOwned(std::unique_ptr<_Ty> owner)
+	{
+		if constexpr (std::is_base_of_v<ICoroutineCommand, _Ty>)
+			co_await owner->ExecuteAsync();
+		else
+			co_return co_await owner->DoAsync();
+	}
+
+	/// @brief Э̽д promise
+	template <typename _Result>
+	Task<void> CompleteInto(Task<_Result> task, std::shared_ptr<std::promise<_Result>> promise)
+	{
+		try
+		{
+			if constexpr (std::is_void_v<_Result>)
+			{
+				co_await std::move(task);
+				promise->set_value();
+			}
+			else
+			{
+				promise->set_value(co_await std::move(task));
+			}
+		}
+		catch (...)
+		{
+			promise->set_exception(std::current_exception());
+		}
+	}
+
+	/// @brief Э̵ȴ
+	class ICanAwait : public IBelongToArchitecture
+	{
+	public:
+		// һ Tick
+		ResumeAwaiter NextFrame() { return ResumeAwaiter(GetScheduler()); }
+
+		// ָʱɼܹĶʱʱںĵһ Tick ָ
+		template <typename _Rep, typename _Period>
+		ResumeAwaiter Delay(std::chrono::duration<_Rep, _Period> duration)
+		{
+			return ResumeAwaiter(GetScheduler(), std::chrono::ceil<std::chrono::nanoseconds>(duration));
+		}
+
+		template <typename _Event>
+		EventAwaiter<_Event> WaitEvent()
+		{
+			static_assert(std::is_base_of_v<IEvent, _Event>,
+				"_Event must inherit from IEvent");
+			return EventAwaiter<_Event>(GetArchitecture());
+		}
+
+		// ЭΪЭִУִ̳ͨ߳Уɺָ
+		template <typename _Ty, typename... Args>
+		auto AwaitCommand(Args&&... args)
+		{
+			static_assert(std::is_base_of_v<IJCommand, _Ty> || std::is_base_of_v<ICoroutineCommand, _Ty>,
+				"_Ty must inherit from IJCommand or ICoroutineCommand");
+
+			auto arch = GetArchitecture().lock();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			if constexpr (std::is_base_of_v<ICoroutineCommand, _Ty>)
+			{
+				auto command = std::make_unique<_Ty>(std::forward<Args>(args)...);
+				command->SetArchitecture(arch);
+				return RunOwned<_Ty, void>(std::move(command));
+			}
+			else
+			{
+				return CommandAwaiter(arch, std::make_unique<_Ty>(std::forward<Args>(args)...));
+			}
+		}
+
+		// Э̲ѯΪЭִ
+		template <typename _Ty, typename... Args>
+		auto AwaitQuery(Args&&... args)
+			-> Task<typename decltype(std::declval<_Ty>().DoAsync())::value_type>
+		{
+			auto arch = GetArchitecture().lock();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException(typeid(_Ty).name());
+			}
+
+			auto query = std::make_unique<_Ty>(std::forward<Args>(args)...);
+			query->SetArchitecture(arch);
+			return RunOwned<_Ty, typename decltype(std::declval<_Ty>().DoAsync())::value_type>(std::move(query));
+		}
+
+	private:
+		CoroutineScheduler& GetScheduler()
+		{
+			auto arch = GetArchitecture().lock();
+			if (!arch)
+			{
+				throw ArchitectureNotSetException("ICanAwait");
+			}
+			return arch->GetCoroutineScheduler();
+		}
+	};
+
+	/// @brief Эӿ
+	class ICoroutineCommand : public ICanSetArchitecture,
+		public ICanGetSystem,
+		public ICanGetModel,
+		public ICanSendCommand,
+		public ICanSendEvent,
+		public ICanSendQuery,
+		public ICanGetUtility,
+		public ICanAwait
+	{
+	public:
+		virtual ~ICoroutineCommand() override = default;
+		virtual Task<void> ExecuteAsync() = 0;
+	};
+
+	/// @brief Э̲ѯӿ
+	template <typename _Ty>
+	class ICoroutineQuery : public ICanSetArchitecture,
+		public ICanGetModel,
+		public ICanGetSystem,
+		public ICanSendQuery,
+		public ICanAwait
+	{
+	public:
+		virtual ~ICoroutineQuery() override = default;
+		virtual Task<_Ty> DoAsync() = 0;
+	};
+#endif
+
+	// ================ ʵ ================
+
+	/// @brief ֡Ԥִеӳ
+	/// ߳ӣ̵֡߳ Drain ԤڰȼִУδִе˳ӵһ֡
+	class CommandScheduler
+	{
+	public:
+		void Enqueue(std::unique_ptr<IJCommand> command, CommandPriority priority)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mQueues[static_cast<size_t>(priority)].push_back(std::move(command));
+			++mDepth;
+		}
+
+		// ÿִ֡һ֤ԤСʱǰ
+		template <typename _Fn>
+		void Drain(std::chrono::nanoseconds budget, _Fn&& execute)
+		{
+			auto start = std::chrono::steady_clock::now();
+			auto now = start;
+			size_t executed = 0;
+			for (;;)
+			{
+				std::unique_ptr<IJCommand> command;
+				{
+					std::lock_guard<std::mutex> lock(mMutex);
+					for (auto& queue : mQueues)
+					{
+						if (!queue.empty())
+						{
+							command = std::move(queue.front());
+							queue.pop_front();
+							--mDepth;
+							break;
+						}
+					}
+				}
+				if (!command)
+					break;
+
+				try
+				{
+					execute(*command);
+				}
+				catch (const std::exception&)
+				{
+				}
+				++executed;
+
+				now = std::chrono::steady_clock::now();
+				if (now - start >= budget)
+					break;
+			}
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			mExecutedLastTick = executed;
+			mLastTickTime = now - start;
+		}
+
+		CommandSchedulerStats GetStats()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return { mDepth, mExecutedLastTick, mLastTickTime };
+		}
+
+	private:
+		std::mutex mMutex;
+		std::deque<std::unique_ptr<IJCommand>> mQueues[3];
+		size_t mDepth = 0;
+		size_t mExecutedLastTick = 0;
+		std::chrono::nanoseconds mLastTickTime {};
+	};
+
+	/// @brief  Model дϷִϵͳÿ֡
+	/// ϵͳΪͻġעϵͳμһ˳ͻϵͳע˳
+	/// ͬһڵϵͳͻִϲи£ִ̲֡߳вȴ
+	class SystemScheduler
+	{
+	public:
+		void Add(ISystem* system)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mSystems.push_back(system);
+			mDirty = true;
+		}
+
+		// עµ Model ½д뼯
+		void Invalidate()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mDirty = true;
+		}
+
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mSystems.clear();
+			mEntries.clear();
+			mBatches.clear();
+			mDirty = false;
+		}
+
+		/// @param getExecutor ĳΰϵͳʱ
+		/// @param resolveModel  Model ͽΪʵڸº汾
+		template <typename _GetExecutor, typename _ResolveModel>
+		void Update(float deltaTime, _GetExecutor&& getExecutor, _ResolveModel&& resolveModel)
+		{
+			RebuildIfDirty(resolveModel);
+
+			for (auto& batch : mBatches)
+			{
+				if (batch.size() == 1)
+				{
+					Run(mEntries[batch.front()], deltaTime);
+					continue;
+				}
+
+				TaskExecutor& executor = getExecutor();
+				BatchRun run { batch.size() - 1, deltaTime };
+				for (size_t i = 1; i < batch.size(); ++i)
+				{
+					Entry* entry = &mEntries[batch[i]];
+					BatchRun* state = &run;
+					executor.Post([state, entry]
+						{
+							Run(*entry, state->deltaTime);
+							state->remaining.fetch_sub(1, std::memory_order_acq_rel);
+						});
+				}
+				Run(mEntries[batch.front()], deltaTime);
+				while (run.remaining.load(std::memory_order_acquire) > 0)
+				{
+					if (!executor.TryRunPendingTask())
+						std::this_thread::yield();
+				}
+			}
+		}
+
+		// ǰλִ֣˳
+		template <typename _ResolveModel>
+		std::vector<std::vector<ISystem*>> GetBatches(_ResolveModel&& resolveModel)
+		{
+			RebuildIfDirty(resolveModel);
+			std::vector<std::vector<ISystem*>> result;
+			for (auto& batch : mBatches)
+			{
+				auto& systems = result.emplace_back();
+				for (size_t index : batch)
+					systems.push_back(mEntries[index].system);
+			}
+			return result;
+		}
+
+	private:
+		struct Entry
+		{
+			ISystem* system;
+			ModelAccess access;
+			std::vector<IModel*> reads;
+			std::vector<IModel*> writes;
+			size_t batch;
+		};
+
+		struct BatchRun
+		{
+			std::atomic<size_t> remaining;
+			float deltaTime;
+		};
+
+		static void Run(Entry& entry, float deltaTime)
+		{
+			try
+			{
+				ModelAccessGuard guard;
+				guard.Acquire(entry.reads, entry.writes);
+				entry.system->Update(deltaTime);
+			}
+			catch (const std::exception&)
+			{
+			}
+			for (auto* model : entry.writes)
+				model->IncrementVersion();
+		}
+
+		template <typename _ResolveModel>
+		void RebuildIfDirty(_ResolveModel& resolveModel)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mDirty)
+				return;
+			mDirty = false;
+			mEntries.clear();
+			mBatches.clear();
+			for (auto* system : mSystems)
+			{
+				ModelAccess access;
+				if (!system->DeclareUpdate(access))
+					continue;
+
+				size_t batch = 0;
+				for (auto& previous : mEntries)
+				{
+					if (previous.batch >= batch && previous.access.ConflictsWith(access))
+						batch = previous.batch + 1;
+				}
+
+				std::vector<IModel*> reads;
+				std::vector<IModel*> writes;
+				for (auto& type : access.GetReads())
+				{
+					if (auto* model = resolveModel(type))
+						reads.push_back(model);
+				}
+				for (auto& type : access.GetWrites())
+				{
+					if (auto* model = resolveModel(type))
+						writes.push_back(model);
+				}
+
+				if (batch == mBatches.size())
+					mBatches.emplace_back();
+				mBatches[batch].push_back(mEntries.size());
+				mEntries.push_back({ system, std::move(access), std::move(reads), std::move(writes), batch });
+			}
+		}
+
+		std::mutex mMutex;
+		std::vector<ISystem*> mSystems; // ע˳
+		std::vector<Entry> mEntries;
+		std::vector<std::vector<size_t>> mBatches;
+		bool mDirty = false;
+	};
+
+	/// @brief ɳʷ¼
+	/// ÿ¼ֻ/ĿС
+	/// ջڴ泬ʱļ¼ʼ
+	class CommandHistory
+	{
+	public:
+		void Push(ChangeSet changeSet)
+		{
+			if (changeSet.Empty())
+				return;
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			// µĲʹջʧЧ
+			for (auto& entry : mRedo)
+				mMemoryUsage -= entry.size;
+			mRedo.clear();
+
+			mMemoryUsage += changeSet.size;
+			mUndo.push_back(std::move(changeSet));
+			TrimLocked();
+		}
+
+		bool Undo()
+		{
+			ChangeSet changeSet;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (mUndo.empty())
+					return false;
+				changeSet = std::move(mUndo.back());
+				mUndo.pop_back();
+			}
+
+			Apply(changeSet, &ChangeSet::Undo);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			mRedo.push_back(std::move(changeSet));
+			return true;
+		}
+
+		bool Redo()
+		{
+			ChangeSet changeSet;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (mRedo.empty())
+					return false;
+				changeSet = std::move(mRedo.back());
+				mRedo.pop_back();
+			}
+
+			Apply(changeSet, &ChangeSet::Redo);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			mUndo.push_back(std::move(changeSet));
+			return true;
+		}
+
+		bool CanUndo()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return !mUndo.empty();
+		}
+
+		bool CanRedo()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return !mRedo.empty();
+		}
+
+		size_t GetUndoCount()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mUndo.size();
+		}
+
+		size_t GetRedoCount()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mRedo.size();
+		}
+
+		size_t GetMemoryUsage()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mMemoryUsage;
+		}
+
+		// ڴޣֽڣЧ
+		void SetMemoryLimit(size_t bytes)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mMemoryLimit = bytes;
+			TrimLocked();
+		}
 
-			auto model = arch->GetModel<_Ty>();
-			return model;
+		size_t GetMemoryLimit()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mMemoryLimit;
+		}
+
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mUndo.clear();
+			mRedo.clear();
+			mMemoryUsage = 0;
+		}
+
+	private:
+		// Ӧã۲߻صпԼ
+		static void Apply(ChangeSet& changeSet, void (ChangeSet::*apply)())
+		{
+			// /µļ¼
+			ChangeRecordScope suspend(nullptr);
+			(changeSet.*apply)();
+			for (auto& weak : changeSet.models)
+			{
+				if (auto model = weak.lock())
+					model->IncrementVersion();
+			}
+		}
+
+		// ȶĳ¼ٶԶ¼
+		void TrimLocked()
+		{
+			while (mMemoryUsage > mMemoryLimit && !mUndo.empty())
+			{
+				mMemoryUsage -= mUndo.front().size;
+				mUndo.pop_front();
+			}
+			while (mMemoryUsage > mMemoryLimit && !mRedo.empty())
+			{
+				mMemoryUsage -= mRedo.front().size;
+				mRedo.pop_front();
+			}
 		}
+
+		std::mutex mMutex;
+		std::deque<ChangeSet> mUndo;
+		std::deque<ChangeSet> mRedo; // βΪһļ¼
+		size_t mMemoryUsage = 0;
+		size_t mMemoryLimit = 16 * 1024 * 1024;
 	};
 
-	/// @brief ȡSystem
-	class ICanGetSystem : public IBelongToArchitecture
+	// ================ ʱ ================
+
+	/// @brief ʱʶ 32 λΪ 32 λΪڵ±ꣻ0 Ӧκζʱ
+	/// ʱڵ㸴ʱɱʶȡ¶ʱ
+	using TimerId = uint64_t;
+
+	class TimerService;
+
+	/// @brief ʱȡƣɼ UnRegisterTrigger ȡ
+	/// ֻжʱãٺ UnRegister ޲
+	class TimerToken : public IUnRegister, public std::enable_shared_from_this<TimerToken>
 	{
 	public:
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetSystem()
+		TimerToken(std::weak_ptr<TimerService> service, TimerId id)
+			: mService(std::move(service))
+			, mId(id)
 		{
-			static_assert(std::is_base_of_v<ISystem, _Ty>,
-				"_Ty must inherit from ISystem");
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
-			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
-			}
+		void UnRegister() override;
 
-			auto system = arch->GetSystem<_Ty>();
-			return system;
+		void UnRegisterWhenObjectDestroyed(UnRegisterTrigger* unRegisterTrigger)
+		{
+			unRegisterTrigger->AddUnRegister(this->shared_from_this());
 		}
+
+		TimerId GetId() const { return mId; }
+
+	private:
+		std::weak_ptr<TimerService> mService;
+		TimerId mId;
 	};
 
-	/// @brief Command
-	class ICanSendCommand : public IBelongToArchitecture
+	/// @brief ֲʱֶʱ
+	/// 4 㡢ÿ 256 ۣС̶Ϊ resolutionĬ 1msԼɱʾ 49 ڵĵʱ
+	/// ȡΪ O(1)ڵڸõĽڵУʱڵ
+	/// ߳̿ɵȡAdvance ̵֡߳ãص Advance ִ̡߳
+	/// ӳһ Advance ʱΪ
+	class TimerService : public std::enable_shared_from_this<TimerService>
 	{
 	public:
-		template <typename _Ty, typename... Args>
-		void SendCommand(Args&&... args)
+		explicit TimerService(std::chrono::nanoseconds resolution = std::chrono::milliseconds(1),
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now())
+			: mResolution(std::max(resolution, std::chrono::nanoseconds(1)))
+			, mStart(start)
 		{
-			static_assert(std::is_base_of_v<IJCommand, _Ty>,
-				"_Ty must inherit from IJCommand");
+			std::fill(std::begin(mSlots), std::end(mSlots), NoTimer);
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+		TimerService(const TimerService&) = delete;
+		TimerService& operator=(const TimerService&) = delete;
+
+		/// @param period ʱΪڶʱÿδ period ٴδֱȡ
+		TimerId Schedule(std::chrono::nanoseconds delay, std::function<void()> callback,
+			std::chrono::nanoseconds period = {})
+		{
+			if (!callback)
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
+				throw std::invalid_argument("Timer callback cannot be null");
 			}
-			arch->SendCommand<_Ty>(std::forward<Args>(args)...);
+
+			std::lock_guard<std::mutex> lock(mMutex);
+			uint32_t index = Allocate();
+			Timer& timer = mTimers[index];
+			timer.callback = std::move(callback);
+			timer.period = period.count() > 0 ? std::max<uint64_t>(1, ToTicks(period)) : 0;
+			timer.expires = mCurrent + std::min(ToTicks(delay), MaxDelay);
+			if (timer.expires == mCurrent)
+			{
+				// ӳһ Advance ʱ
+				timer.slot = DueSlot;
+				mDue.push_back(index);
+			}
+			else
+			{
+				Insert(index);
+			}
+			++mActiveCount;
+			return (static_cast<TimerId>(timer.generation) << 32) | index;
 		}
 
-		void SendCommand(std::unique_ptr<IJCommand> command)
+		// ȡʱѴһԶʱȡʱ false
+		bool Cancel(TimerId id)
+		{
+			std::function<void()> callback;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				uint32_t index = static_cast<uint32_t>(id);
+				if (index >= mTimers.size())
+					return false;
+				Timer& timer = mTimers[index];
+				if (timer.generation != static_cast<uint32_t>(id >> 32) || timer.slot == FreeSlot ||
+					timer.cancelled.load(std::memory_order_relaxed))
+					return false;
+
+				timer.cancelled.store(true, std::memory_order_release);
+				if (timer.slot == FiringSlot || timer.slot == DueSlot)
+					return true; //  Advance ڴ
+				Unlink(index);
+				callback = Free(index);
+			}
+			// صеĶ
+			return true;
+		}
+
+		// Ϊʱɼ UnRegisterTrigger ȡ
+		std::shared_ptr<TimerToken> MakeToken(TimerId id)
 		{
+			return std::make_shared<TimerToken>(weak_from_this(), id);
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+		// ƽ nowеڵĶʱش
+		size_t Advance(std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now())
+		{
+			std::vector<uint32_t> firing;
+			std::vector<Timer*> timers;
 			{
-				throw ArchitectureNotSetException(typeid(command).name());
+				std::lock_guard<std::mutex> lock(mMutex);
+				uint64_t target = now > mStart ? static_cast<uint64_t>((now - mStart) / mResolution) : 0;
+				firing.swap(mDue);
+				if (mActiveCount == firing.size())
+				{
+					// ʱΪգֱĿ̶
+					mCurrent = std::max(mCurrent, target);
+				}
+				while (mCurrent < target)
+				{
+					//  0 Ŀղۣʱδƽʱ̶ȱ
+					mCurrent = std::min(NextEventTick(), target);
+					Cascade();
+					size_t slot = mCurrent & SlotMask;
+					for (uint32_t index = mSlots[slot]; index != NoTimer;)
+					{
+						uint32_t next = mTimers[index].next;
+						mTimers[index].slot = FiringSlot;
+						firing.push_back(index);
+						index = next;
+					}
+					mSlots[slot] = NoTimer;
+					MarkEmpty(slot);
+				}
+				for (uint32_t index : firing)
+				{
+					mTimers[index].slot = FiringSlot;
+					timers.push_back(&mTimers[index]);
+				}
 			}
-			arch->SendCommand(std::move(command));
+
+			// ڵΪ dequeڼ䲢ڵ㲻ʹнڵʧЧ
+			size_t fired = 0;
+			for (Timer* timer : timers)
+			{
+				if (timer->cancelled.load(std::memory_order_acquire))
+					continue;
+				try
+				{
+					timer->callback();
+				}
+				catch (const std::exception&)
+				{
+				}
+				++fired;
+			}
+
+			std::vector<std::function<void()>> finished;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				for (uint32_t index : firing)
+				{
+					Timer& timer = mTimers[index];
+					if (timer.cancelled.load(std::memory_order_relaxed) || timer.period == 0)
+					{
+						finished.push_back(Free(index));
+						continue;
+					}
+					timer.expires = std::max(timer.expires + timer.period, mCurrent + 1);
+					Insert(index);
+				}
+			}
+			return fired;
 		}
-	};
 
-	/// @brief Command
-	class ICanSendQuery : public IBelongToArchitecture
-	{
-	public:
-		template <typename _Ty, typename... Args>
-		auto SendQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+		// δĶʱڶʱ
+		size_t GetActiveCount()
 		{
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mActiveCount;
+		}
+
+		// ȡжʱ Advance ̵߳
+		void Clear()
+		{
+			std::vector<std::function<void()>> callbacks;
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (size_t i = 0; i < mTimers.size(); ++i)
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
+				if (mTimers[i].slot != FreeSlot)
+					callbacks.push_back(Free(static_cast<uint32_t>(i)));
 			}
+			std::fill(std::begin(mSlots), std::end(mSlots), NoTimer);
+			std::fill(std::begin(mOccupied), std::end(mOccupied), 0);
+			mDue.clear();
+		}
 
-			auto result = arch->SendQuery<_Ty>(std::forward<Args>(args)...);
-			return result;
+	private:
+		static constexpr uint32_t NoTimer = UINT32_MAX;
+		static constexpr size_t LevelBits = 8;
+		static constexpr size_t LevelCount = 4;
+		static constexpr uint64_t SlotMask = (1u << LevelBits) - 1;
+		static constexpr uint64_t MaxDelay = (uint64_t(1) << (LevelBits * LevelCount)) - 1;
+		// Timer::slot ȡֵ
+		static constexpr uint32_t FreeSlot = UINT32_MAX;
+		static constexpr uint32_t FiringSlot = UINT32_MAX - 1;
+		static constexpr uint32_t DueSlot = UINT32_MAX - 2;
+
+		struct Timer
+		{
+			std::function<void()> callback;
+			uint64_t expires = 0; // ̶
+			uint64_t period = 0;  // ̶ȣ0 Ϊһ
+			uint32_t generation = 1;
+			uint32_t prev = NoTimer;
+			uint32_t next = NoTimer; // ʱΪһ
+			uint32_t slot = FreeSlot;
+			std::atomic<bool> cancelled { false }; // ڼɱ߳λ
+		};
+
+		// ȡʱӳٴ
+		uint64_t ToTicks(std::chrono::nanoseconds duration) const
+		{
+			if (duration.count() <= 0)
+				return 0;
+			uint64_t count = static_cast<uint64_t>(duration.count());
+			uint64_t resolution = static_cast<uint64_t>(mResolution.count());
+			return count / resolution + (count % resolution != 0);
 		}
 
-		template <typename _Ty>
-		auto SendQuery(std::unique_ptr<_Ty> query)
-			-> decltype(std::declval<_Ty>().Do())
+		uint32_t Allocate()
 		{
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+			if (mFreeList != NoTimer)
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
+				uint32_t index = mFreeList;
+				mFreeList = mTimers[index].next;
+				return index;
 			}
+			mTimers.emplace_back();
+			return static_cast<uint32_t>(mTimers.size() - 1);
+		}
 
-			auto result = arch->SendQuery(std::move(query));
-			return result;
+		std::function<void()> Free(uint32_t index)
+		{
+			Timer& timer = mTimers[index];
+			auto callback = std::move(timer.callback);
+			timer.callback = nullptr;
+			timer.slot = FreeSlot;
+			timer.cancelled.store(false, std::memory_order_relaxed);
+			timer.generation++;
+			timer.next = mFreeList;
+			mFreeList = index;
+			--mActiveCount;
+			return callback;
 		}
-	};
 
-	class ICanGetUtility : public IBelongToArchitecture
-	{
-	public:
-		template <typename _Ty>
-		std::shared_ptr<_Ty> GetUtility()
+		// ൽڵĿ̶ѡ㼶 n Ĳ۸ 256^n ̶
+		void Insert(uint32_t index)
 		{
-			static_assert(std::is_base_of_v<IUtility, _Ty>,
-				"_Ty must inherit from IUtility");
+			Timer& timer = mTimers[index];
+			uint64_t delta = std::min(timer.expires - mCurrent, MaxDelay);
+			timer.expires = mCurrent + delta;
+			size_t level = 0;
+			while (level + 1 < LevelCount && delta >= (uint64_t(1) << (LevelBits * (level + 1))))
+				++level;
+			uint32_t slot = static_cast<uint32_t>(level * (SlotMask + 1) + ((timer.expires >> (LevelBits * level)) & SlotMask));
+
+			timer.slot = slot;
+			timer.prev = NoTimer;
+			timer.next = mSlots[slot];
+			if (timer.next != NoTimer)
+				mTimers[timer.next].prev = index;
+			mSlots[slot] = index;
+			if (level == 0)
+				mOccupied[slot / 64] |= uint64_t(1) << (slot % 64);
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+		void Unlink(uint32_t index)
+		{
+			Timer& timer = mTimers[index];
+			if (timer.prev != NoTimer)
+				mTimers[timer.prev].next = timer.next;
+			else
+				mSlots[timer.slot] = timer.next;
+			if (timer.next != NoTimer)
+				mTimers[timer.next].prev = timer.prev;
+			if (mSlots[timer.slot] == NoTimer)
+				MarkEmpty(timer.slot);
+		}
+
+		void MarkEmpty(size_t slot)
+		{
+			if (slot <= SlotMask)
+				mOccupied[slot / 64] &= ~(uint64_t(1) << (slot % 64));
+		}
+
+		// һҪĿ̶ȣȦڵ 0 һǿղۣһμ
+		uint64_t NextEventTick() const
+		{
+			uint64_t boundary = (mCurrent | SlotMask) + 1;
+			uint64_t from = (mCurrent + 1) & SlotMask;
+			if (from == 0)
+				return boundary;
+			for (size_t word = from / 64; word < std::size(mOccupied); ++word)
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
+				uint64_t bits = mOccupied[word];
+				if (word == from / 64)
+					bits &= ~uint64_t(0) << (from % 64);
+				if (bits != 0)
+					return (mCurrent & ~SlotMask) + word * 64 + LowestBit(bits);
 			}
+			return boundary;
+		}
 
-			auto utility = arch->GetUtility<_Ty>();
-			return utility;
+		static unsigned LowestBit(uint64_t value)
+		{
+#if defined(_MSC_VER) && defined(_WIN64)
+			unsigned long index;
+			_BitScanForward64(&index, value);
+			return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+			return static_cast<unsigned>(__builtin_ctzll(value));
+#else
+			unsigned bit = 0;
+			while ((value & 1) == 0)
+			{
+				value >>= 1;
+				++bit;
+			}
+			return bit;
+#endif
+		}
+
+		// ͲתһȦʱѸ߲㵱ǰ۵Ķʱ·䵽Ͳ
+		void Cascade()
+		{
+			size_t levels = 0;
+			while (levels + 1 < LevelCount && ((mCurrent >> (LevelBits * (levels + 1))) << (LevelBits * (levels + 1))) == mCurrent)
+				++levels;
+			for (size_t level = levels; level >= 1; --level)
+			{
+				uint32_t slot = static_cast<uint32_t>(level * (SlotMask + 1) + ((mCurrent >> (LevelBits * level)) & SlotMask));
+				uint32_t index = mSlots[slot];
+				mSlots[slot] = NoTimer;
+				while (index != NoTimer)
+				{
+					uint32_t next = mTimers[index].next;
+					Insert(index);
+					index = next;
+				}
+			}
 		}
+
+		std::chrono::nanoseconds mResolution;
+		std::chrono::steady_clock::time_point mStart;
+		std::mutex mMutex;
+		std::deque<Timer> mTimers;
+		uint32_t mFreeList = NoTimer;
+		uint32_t mSlots[LevelCount * (SlotMask + 1)];
+		uint64_t mOccupied[(SlotMask + 1) / 64] = {}; //  0 ǿղ۵λͼ
+		std::vector<uint32_t> mDue; // ӳٵĶʱ
+		uint64_t mCurrent = 0;      // ѴĿ̶
+		size_t mActiveCount = 0;
 	};
 
-	// ================ ¼עӿ ================
+	inline void TimerToken::UnRegister()
+	{
+		if (auto service = mService.lock())
+			service->Cancel(mId);
+	}
 
-	/// @brief Event
-	class ICanSendEvent : public IBelongToArchitecture
+#if JFRAMEWORK_HAS_COROUTINES
+	inline void CoroutineScheduler::ScheduleAfter(std::chrono::nanoseconds delay, std::coroutine_handle<> handle)
+	{
+		// Ǽǣʱ߳ʱ Wake ȴǼ
+		std::lock_guard<std::mutex> lock(mMutex);
+		uint64_t sequence = mDelaySequence++;
+		TimerId timer = mTimerService->Schedule(delay, [this, sequence] { Wake(sequence); });
+		mDelayed.emplace(sequence, Delayed { handle, timer });
+	}
+
+	// Эٺȡ䶨ʱصٷʵ
+	inline void CoroutineScheduler::CancelDelayed(const std::unordered_map<uint64_t, Delayed>& delayed)
+	{
+		for (auto& entry : delayed)
+			mTimerService->Cancel(entry.second.timer);
+	}
+#endif
+
+	// ================ ָ ================
+
+	// ߳״μ¼ʱ䵽ƬͬһƬϵ߳̽٣
+	inline size_t MetricShardIndex(size_t shardCount)
+	{
+		static std::atomic<size_t> next { 0 };
+		thread_local size_t index = next.fetch_add(1, std::memory_order_relaxed);
+		return index % shardCount;
+	}
+
+	/// @brief ̷߳Ƭȡʱϲ
+	class MetricCounter
 	{
 	public:
-		template <typename _Ty, typename... Args>
-		void SendEvent(Args&&... args)
+		static constexpr size_t ShardCount = 16;
+
+		void Add(uint64_t delta = 1)
 		{
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
+			mShards[MetricShardIndex(ShardCount)].value.fetch_add(delta, std::memory_order_relaxed);
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+		uint64_t GetValue() const
+		{
+			uint64_t value = 0;
+			for (auto& shard : mShards)
+				value += shard.value.load(std::memory_order_relaxed);
+			return value;
+		}
+
+	private:
+		// ÿƬռУⲻ̵ͬ߳ĵʧЧ
+		struct alignas(64) Shard
+		{
+			std::atomic<uint64_t> value { 0 };
+		};
+
+		Shard mShards[ShardCount];
+	};
+
+	/// @brief ˲ʱֵָ꣬ȡʵ
+	class MetricGauge
+	{
+	public:
+		void Set(int64_t value) { mValue.store(value, std::memory_order_relaxed); }
+
+		void Add(int64_t delta) { mValue.fetch_add(delta, std::memory_order_relaxed); }
+
+		int64_t GetValue() const { return mValue.load(std::memory_order_relaxed); }
+
+	private:
+		std::atomic<int64_t> mValue { 0 };
+	};
+
+	/// @brief ֱͼգͰѺϲ
+	struct HistogramSnapshot
+	{
+		uint64_t count = 0;
+		uint64_t sum = 0;
+		uint64_t min = 0;
+		uint64_t max = 0;
+		std::vector<uint64_t> buckets;
+
+		double Mean() const { return count ? static_cast<double>(sum) / static_cast<double>(count) : 0.0; }
+
+		// percentile ȡֵ [0, 100]ͰϽ磬 1/16
+		uint64_t Percentile(double percentile) const;
+	};
+
+	/// @brief ԷͰֱͼHDR 񣩣¼Ǹӳ
+	/// С 32 ֵȷ¼ֵλֶΡÿ 16 Ͱ
+	/// Ƭ߳״μ¼ʱ䣬¼ֻԭӵ
+	class MetricHistogram
+	{
+	public:
+		static constexpr size_t ShardCount = 16;
+		static constexpr unsigned SubBucketBits = 4;
+		static constexpr size_t SubBucketCount = size_t(1) << SubBucketBits;
+		static constexpr size_t BucketCount = (65 - SubBucketBits) * SubBucketCount;
+
+		MetricHistogram() = default;
+		MetricHistogram(const MetricHistogram&) = delete;
+		MetricHistogram& operator=(const MetricHistogram&) = delete;
+
+		~MetricHistogram()
+		{
+			for (auto& shard : mShards)
+				delete shard.load(std::memory_order_relaxed);
+		}
+
+		void Record(uint64_t value)
+		{
+			Shard& shard = GetShard();
+			shard.buckets[BucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+			shard.count.fetch_add(1, std::memory_order_relaxed);
+			shard.sum.fetch_add(value, std::memory_order_relaxed);
+			uint64_t min = shard.min.load(std::memory_order_relaxed);
+			while (value < min && !shard.min.compare_exchange_weak(min, value, std::memory_order_relaxed))
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
 			}
-			arch->SendEvent<_Ty>(std::forward<Args>(args)...);
+			uint64_t max = shard.max.load(std::memory_order_relaxed);
+			while (value > max && !shard.max.compare_exchange_weak(max, value, std::memory_order_relaxed))
+			{
+			}
+		}
+
+		void Record(std::chrono::nanoseconds duration)
+		{
+			Record(static_cast<uint64_t>(std::max<std::chrono::nanoseconds::rep>(0, duration.count())));
+		}
+
+		// ¼жȡʱֶομ¼
+		HistogramSnapshot Snapshot() const
+		{
+			HistogramSnapshot snapshot;
+			snapshot.buckets.assign(BucketCount, 0);
+			uint64_t min = UINT64_MAX;
+			for (auto& slot : mShards)
+			{
+				Shard* shard = slot.load(std::memory_order_acquire);
+				if (!shard)
+					continue;
+				for (size_t i = 0; i < BucketCount; ++i)
+					snapshot.buckets[i] += shard->buckets[i].load(std::memory_order_relaxed);
+				snapshot.count += shard->count.load(std::memory_order_relaxed);
+				snapshot.sum += shard->sum.load(std::memory_order_relaxed);
+				min = std::min(min, shard->min.load(std::memory_order_relaxed));
+				snapshot.max = std::max(snapshot.max, shard->max.load(std::memory_order_relaxed));
+			}
+			snapshot.min = snapshot.count ? min : 0;
+			return snapshot;
+		}
+
+		static size_t BucketIndex(uint64_t value)
+		{
+			if (value < 2 * SubBucketCount)
+				return static_cast<size_t>(value);
+			unsigned shift = HighestBit(value) - SubBucketBits;
+			return shift * SubBucketCount + static_cast<size_t>(value >> shift);
+		}
+
+		// Ͱڿɼ¼ֵ
+		static uint64_t BucketUpperBound(size_t index)
+		{
+			if (index < 2 * SubBucketCount)
+				return index;
+			unsigned shift = static_cast<unsigned>(index / SubBucketCount - 1);
+			uint64_t mantissa = index - shift * SubBucketCount;
+			return ((mantissa + 1) << shift) - 1;
+		}
+
+	private:
+		struct Shard
+		{
+			std::atomic<uint64_t> buckets[BucketCount] = {};
+			std::atomic<uint64_t> count { 0 };
+			std::atomic<uint64_t> sum { 0 };
+			std::atomic<uint64_t> min { UINT64_MAX };
+			std::atomic<uint64_t> max { 0 };
+		};
+
+		Shard& GetShard()
+		{
+			auto& slot = mShards[MetricShardIndex(ShardCount)];
+			Shard* shard = slot.load(std::memory_order_acquire);
+			if (shard)
+				return *shard;
+			auto* created = new Shard();
+			if (slot.compare_exchange_strong(shard, created, std::memory_order_acq_rel))
+				return *created;
+			delete created;
+			return *shard;
+		}
+
+		static unsigned HighestBit(uint64_t value)
+		{
+#if defined(_MSC_VER) && defined(_WIN64)
+			unsigned long index;
+			_BitScanReverse64(&index, value);
+			return static_cast<unsigned>(index);
+#elif defined(__GNUC__)
+			return 63u - static_cast<unsigned>(__builtin_clzll(value));
+#else
+			unsigned bit = 0;
+			while (value >>= 1)
+				++bit;
+			return bit;
+#endif
+		}
+
+		std::atomic<Shard*> mShards[ShardCount] = {};
+	};
+
+	inline uint64_t HistogramSnapshot::Percentile(double percentile) const
+	{
+		if (count == 0)
+			return 0;
+		if (percentile <= 0.0)
+			return min;
+		double rank = percentile >= 100.0 ? static_cast<double>(count) : percentile / 100.0 * static_cast<double>(count);
+		uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(rank + 0.999999));
+		uint64_t seen = 0;
+		for (size_t i = 0; i < buckets.size(); ++i)
+		{
+			seen += buckets[i];
+			if (seen >= target)
+				return std::min(MetricHistogram::BucketUpperBound(i), max);
+		}
+		return max;
+	}
+
+	/// @brief ָ
+	struct MetricsSnapshot
+	{
+		std::chrono::steady_clock::time_point time;
+		std::unordered_map<std::string, uint64_t> counters;
+		std::unordered_map<std::string, int64_t> gauges;
+		std::unordered_map<std::string, HistogramSnapshot> histograms;
+
+		//  earlier ÿÿ¼ÿķʹ
+		double Rate(const MetricsSnapshot& earlier, const std::string& counter) const
+		{
+			auto it = counters.find(counter);
+			if (it == counters.end())
+				return 0.0;
+			auto before = earlier.counters.find(counter);
+			uint64_t delta = it->second - (before != earlier.counters.end() ? before->second : 0);
+			double seconds = std::chrono::duration<double>(time - earlier.time).count();
+			return seconds > 0.0 ? static_cast<double>(delta) / seconds : 0.0;
 		}
 	};
 
-	/// @brief ע/ע¼
-	class ICanRegisterEvent : public IBelongToArchitecture
+	/// @brief ָעܹõ IUtilityͨ GetUtility<MetricsRegistry>() ȡ
+	/// ƻȡָصעڼЧ¼
+	///  Architecture::EnableFrameworkMetrics 󣬿ܰͼ¼
+	/// "event:<>" ¼ʹ"command:<>" / "query:<>" ִкʱ룩
+	class MetricsRegistry : public IUtility
 	{
 	public:
-		virtual ~ICanRegisterEvent() = default;
+		static constexpr const char* EventPrefix = "event:";
+		static constexpr const char* CommandPrefix = "command:";
+		static constexpr const char* QueryPrefix = "query:";
 
-		template <typename _Ty>
-		void RegisterEvent(ICanHandleEvent* handler)
+		MetricsRegistry()
+			: mId(NextId())
 		{
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
-			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
-			}
+		MetricCounter& GetCounter(const std::string& name) { return GetOrCreate<MetricCounter>(name); }
 
-			arch->RegisterEvent<_Ty>(handler);
+		MetricGauge& GetGauge(const std::string& name) { return GetOrCreate<MetricGauge>(name); }
+
+		MetricHistogram& GetHistogram(const std::string& name) { return GetOrCreate<MetricHistogram>(name); }
+
+		MetricCounter& GetEventCounter(const std::type_info& type) { return GetTypeMetric<MetricCounter>(EventPrefix, type); }
+
+		MetricHistogram& GetCommandLatency(const std::type_info& type) { return GetTypeMetric<MetricHistogram>(CommandPrefix, type); }
+
+		MetricHistogram& GetQueryLatency(const std::type_info& type) { return GetTypeMetric<MetricHistogram>(QueryPrefix, type); }
+
+		// ܰͼ¼ָ
+		static std::string TypeMetricName(const char* prefix, const std::type_info& type)
+		{
+			return prefix + DemangleTypeName(type.name());
 		}
 
-		template <typename _Ty>
-		void UnRegisterEvent(ICanHandleEvent* handler)
+		MetricsSnapshot Snapshot() const
 		{
-			static_assert(std::is_base_of_v<IEvent, _Ty>,
-				"_Ty must inherit from IEvent");
+			MetricsSnapshot snapshot;
+			std::lock_guard<std::mutex> lock(mMutex);
+			snapshot.time = std::chrono::steady_clock::now();
+			for (auto& [name, counter] : mCounters)
+				snapshot.counters.emplace(name, counter->GetValue());
+			for (auto& [name, gauge] : mGauges)
+				snapshot.gauges.emplace(name, gauge->GetValue());
+			for (auto& [name, histogram] : mHistograms)
+				snapshot.histograms.emplace(name, histogram->Snapshot());
+			return snapshot;
+		}
 
-			auto arch = GetArchitecture().lock();
-			if (!arch)
+	private:
+		template <typename>
+		struct MetricTypeTag {};
+		auto& GetMetrics(MetricTypeTag<MetricCounter>) { return mCounters; }
+		auto& GetMetrics(MetricTypeTag<MetricGauge>) { return mGauges; }
+		auto& GetMetrics(MetricTypeTag<MetricHistogram>) { return mHistograms; }
+
+		template <typename _Metric>
+		_Metric& GetOrCreate(const std::string& name)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto& metrics = GetMetrics(MetricTypeTag<_Metric> {});
+			auto& metric = metrics[name];
+			if (!metric)
+				metric = std::make_unique<_Metric>();
+			return *metric;
+		}
+
+		// עֻעٺ仺ᱻע
+		template <typename _Metric>
+		_Metric& GetTypeMetric(const char* prefix, const std::type_info& type)
+		{
+			using Key = std::tuple<uint64_t, const char*, const std::type_info*>;
+			struct KeyHash
 			{
-				throw ArchitectureNotSetException(typeid(_Ty).name());
-			}
+				size_t operator()(const Key& key) const
+				{
+					size_t hash = std::hash<uint64_t>()(std::get<0>(key));
+					hash ^= std::hash<const void*>()(std::get<1>(key)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+					hash ^= std::hash<const void*>()(std::get<2>(key)) + 0x9e3779b9 + (hash << 6) + (hash >> 2);
+					return hash;
+				}
+			};
+			thread_local std::unordered_map<Key, _Metric*, KeyHash> cache;
+
+			Key key(mId, prefix, &type);
+			auto it = cache.find(key);
+			if (it != cache.end())
+				return *it->second;
+			auto& metric = GetOrCreate<_Metric>(TypeMetricName(prefix, type));
+			cache.emplace(key, &metric);
+			return metric;
+		}
 
-			arch->UnRegisterEvent<_Ty>(handler);
+		static uint64_t NextId()
+		{
+			static std::atomic<uint64_t> next { 0 };
+			return next.fetch_add(1, std::memory_order_relaxed);
 		}
-	};
 
-	// ================ ӿ ================
+		uint64_t mId;
+		mutable std::mutex mMutex;
+		std::unordered_map<std::string, std::unique_ptr<MetricCounter>> mCounters;
+		std::unordered_map<std::string, std::unique_ptr<MetricGauge>> mGauges;
+		std::unordered_map<std::string, std::unique_ptr<MetricHistogram>> mHistograms;
+	};
 
-	/// @brief ӿ
-	class IJCommand : public ICanSetArchitecture,
-		public ICanGetSystem,
-		public ICanGetModel,
-		public ICanSendCommand,
-		public ICanSendEvent,
-		public ICanSendQuery,
-		public ICanGetUtility
+	/// @brief ʱѺʱ¼ֱͼֱͼΪʱȡʱ
+	class LatencyScope
 	{
 	public:
-		virtual ~IJCommand() override = default;
-		virtual void Execute() = 0;
-	};
+		explicit LatencyScope(MetricHistogram* histogram)
+			: mHistogram(histogram)
+		{
+			if (mHistogram)
+				mStart = std::chrono::steady_clock::now();
+		}
 
-	/// @brief Modelӿ
-	class IModel : public ICanSetArchitecture,
-		public ICanInit,
-		public ICanSendEvent,
-		public ICanSendQuery,
-		public ICanGetUtility,
-		public ICanGetModel
-	{
-	};
+		~LatencyScope()
+		{
+			if (mHistogram)
+				mHistogram->Record(std::chrono::steady_clock::now() - mStart);
+		}
 
-	/// @brief Systemӿ
-	class ISystem : public ICanSetArchitecture,
-		public ICanInit,
-		public ICanGetModel,
-		public ICanHandleEvent,
-		public ICanGetSystem,
-		public ICanRegisterEvent,
-		public ICanSendEvent,
-		public ICanSendQuery,
-		public ICanGetUtility
-	{
+		LatencyScope(const LatencyScope&) = delete;
+		LatencyScope& operator=(const LatencyScope&) = delete;
+
+	private:
+		MetricHistogram* mHistogram;
+		std::chrono::steady_clock::time_point mStart;
 	};
 
-	// @brief Controllerӿ
-	class IController : public ICanGetSystem,
-		public ICanGetModel,
-		public ICanSendCommand,
-		public ICanSendEvent,
-		public ICanHandleEvent,
-		public ICanRegisterEvent,
-		public ICanSendQuery,
-		public ICanGetUtility
+	// ================ ־ ================
+
+	struct CommandJournalStats
 	{
+		uint64_t recordsAppended = 0;
+		uint64_t bytesWritten = 0;
+		uint64_t syncCount = 0; // fsync Сڼ¼˵ύ
 	};
 
-	/// @brief Queryӿ
-	template <typename _Ty>
-	class IQuery : public ICanSetArchitecture,
-		public ICanGetModel,
-		public ICanGetSystem,
-		public ICanSendQuery
+	/// @brief ־дˣļʵּ JFrameworkJournal.h е CommandJournal
+	class ICommandJournal
 	{
 	public:
-		virtual ~IQuery() override = default;
-		virtual _Ty Do() = 0;
+		virtual ~ICommandJournal() = default;
+
+		// ׷һ¼ţ 1 ʼȴ
+		virtual uint64_t Append(std::string_view name, std::string_view payload) = 0;
+
+		// Ҫͬ־ûʵڴ˵ȴŲ sequence ļ¼
+		virtual void Commit(uint64_t sequence) = 0;
+
+		// дձǣ÷ڱ Model պãطŴһ֮ʼ
+		virtual void MarkSnapshot(std::string_view tag) = 0;
+
+		// ȴ׷ӵļ¼ȫ
+		virtual void Flush() = 0;
+
+		virtual CommandJournalStats GetStats() = 0;
 	};
 
-	class IUtility
+	/// @brief ѯ
+	/// ѯͰĿ¼ʱ Model 汾һ汾仯ʧЧ
+	class QueryCache
 	{
 	public:
-		virtual ~IUtility() = default; // 
-	};
+		template <typename _Query, typename _Result, typename _Key>
+		class Bucket
+		{
+		public:
+			// δ仯ʱػ
+			std::optional<_Result> Find(const _Key& key)
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				auto it = mEntries.find(key);
+				if (it == mEntries.end())
+					return std::nullopt;
+				for (auto& dependency : it->second.dependencies)
+				{
+					if (dependency.model->GetVersion() != dependency.version)
+					{
+						mEntries.erase(it);
+						return std::nullopt;
+					}
+				}
+				return it->second.result;
+			}
 
-	// ================ ʵ ================
+			void Store(_Key key, const _Result& result,
+				std::vector<ModelAccessTracker::Access> dependencies, size_t maxEntries)
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (mEntries.size() >= maxEntries)
+					mEntries.clear();
+				mEntries.insert_or_assign(std::move(key), Entry { result, std::move(dependencies) });
+			}
+
+			void Clear()
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mEntries.clear();
+			}
+
+		private:
+			struct Entry
+			{
+				_Result result;
+				std::vector<ModelAccessTracker::Access> dependencies;
+			};
+
+			struct KeyHash
+			{
+				size_t operator()(const _Key& key) const
+				{
+					size_t seed = 0;
+					std::apply([&seed](const auto&... values)
+						{
+							((seed ^= std::hash<std::decay_t<decltype(values)>> {}(values) + 0x9e3779b9 + (seed << 6) + (seed >> 2)), ...);
+						},
+						key);
+					return seed;
+				}
+			};
+
+			std::mutex mMutex;
+			std::unordered_map<_Key, Entry, KeyHash> mEntries;
+		};
+
+		template <typename _Query, typename _Result, typename _Key>
+		Bucket<_Query, _Result, _Key>& GetBucket()
+		{
+			using BucketType = Bucket<_Query, _Result, _Key>;
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto& holder = mBuckets[typeid(BucketType)];
+			if (!holder)
+			{
+				holder = std::make_unique<BucketHolder<BucketType>>();
+			}
+			return static_cast<BucketHolder<BucketType>*>(holder.get())->bucket;
+		}
+
+		void Clear()
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& pair : mBuckets)
+			{
+				pair.second->Clear();
+			}
+		}
+
+		// ÿͰĿͰ
+		void SetMaxEntriesPerQuery(size_t maxEntries) { mMaxEntriesPerQuery = maxEntries; }
+		size_t GetMaxEntriesPerQuery() const { return mMaxEntriesPerQuery; }
+
+	private:
+		struct IBucketHolder
+		{
+			virtual ~IBucketHolder() = default;
+			virtual void Clear() = 0;
+		};
+
+		template <typename _Bucket>
+		struct BucketHolder : IBucketHolder
+		{
+			_Bucket bucket;
+			void Clear() override { bucket.Clear(); }
+		};
+
+		std::mutex mMutex;
+		std::unordered_map<std::type_index, std::unique_ptr<IBucketHolder>> mBuckets;
+		size_t mMaxEntriesPerQuery = 1024;
+	};
 
 	/// @brief IOCʵ
 	class IOCContainer
@@ -858,20 +5938,23 @@ namespace JFramework
 		void Register(std::type_index typeId, std::shared_ptr<TBase> component)
 		{
 			static_assert(std::is_base_of_v<TBase, _Ty>, "_Ty must inherit from TBase");
+			JFRAMEWORK_ALLOCATION_SCOPE(RegisterComponent);
 			auto& container = GetContainer(ContainerTypeTag<TBase> {});
-			std::lock_guard<std::mutex> lock(GetMutex(MutexTypeTag<TBase> {}));
+			std::lock_guard<FrameworkMutex> lock(GetMutex(MutexTypeTag<TBase> {}));
 
 			if (container.find(typeId.name()) != container.end())
 				throw ComponentAlreadyRegisteredException(typeId.name());
 
 			container[typeId.name()] = std::static_pointer_cast<TBase>(component);
+			mGeneration.store(NextGeneration(), std::memory_order_release);
 		}
 
 		template <typename TBase>
 		std::shared_ptr<TBase> Get(std::type_index typeId)
 		{
+			JFRAMEWORK_ALLOCATION_SCOPE(GetComponent);
 			auto& container = GetContainer(ContainerTypeTag<TBase> {});
-			std::lock_guard<std::mutex> lock(GetMutex(MutexTypeTag<TBase> {}));
+			std::lock_guard<FrameworkMutex> lock(GetMutex(MutexTypeTag<TBase> {}));
 			auto it = container.find(typeId.name());
 			return it != container.end() ? it->second : nullptr;
 		}
@@ -880,7 +5963,7 @@ namespace JFramework
 		std::vector<std::shared_ptr<TBase>> GetAll()
 		{
 			auto& container = GetContainer(ContainerTypeTag<TBase> {});
-			std::lock_guard<std::mutex> lock(GetMutex(MutexTypeTag<TBase> {}));
+			std::lock_guard<FrameworkMutex> lock(GetMutex(MutexTypeTag<TBase> {}));
 			std::vector<std::shared_ptr<TBase>> result;
 			for (auto& pair : container)
 			{
@@ -891,15 +5974,25 @@ namespace JFramework
 
 		void Clear()
 		{
-			std::lock_guard<std::mutex> lock1(mModelMutex);
-			std::lock_guard<std::mutex> lock2(mSystemMutex);
-			std::lock_guard<std::mutex> lock3(mUtilityMutex);
+			std::lock_guard<FrameworkMutex> lock1(mModelMutex);
+			std::lock_guard<FrameworkMutex> lock2(mSystemMutex);
+			std::lock_guard<FrameworkMutex> lock3(mUtilityMutex);
 			mModels.clear();
 			mSystems.clear();
 			mUtilitys.clear();
+			mGeneration.store(NextGeneration(), std::memory_order_release);
 		}
 
+		// עעʱ£ȡȫּ֮ͬҲظ
+		uint64_t GetGeneration() const { return mGeneration.load(std::memory_order_acquire); }
+
 	private:
+		static uint64_t NextGeneration()
+		{
+			static std::atomic<uint64_t> next { 0 };
+			return next.fetch_add(1, std::memory_order_relaxed) + 1;
+		}
+
 		template <typename>
 		struct ContainerTypeTag {};
 		auto& GetContainer(ContainerTypeTag<IModel>) { return mModels; }
@@ -912,13 +6005,15 @@ namespace JFramework
 		auto& GetMutex(MutexTypeTag<ISystem>) { return mSystemMutex; }
 		auto& GetMutex(MutexTypeTag<IUtility>) { return mUtilityMutex; }
 
-		std::unordered_map<std::string, std::shared_ptr<IModel>> mModels;
-		std::unordered_map<std::string, std::shared_ptr<ISystem>> mSystems;
-		std::unordered_map<std::string, std::shared_ptr<IUtility>> mUtilitys;
+		// Ϊ type_info::name()ָ̬洢ַʱ std::stringҲ
+		std::unordered_map<std::string_view, std::shared_ptr<IModel>> mModels;
+		std::unordered_map<std::string_view, std::shared_ptr<ISystem>> mSystems;
+		std::unordered_map<std::string_view, std::shared_ptr<IUtility>> mUtilitys;
 
-		std::mutex mModelMutex;
-		std::mutex mSystemMutex;
-		std::mutex mUtilityMutex;
+		FrameworkMutex mModelMutex { "IOCContainer::mModelMutex" };
+		FrameworkMutex mSystemMutex { "IOCContainer::mSystemMutex" };
+		FrameworkMutex mUtilityMutex { "IOCContainer::mUtilityMutex" };
+		std::atomic<uint64_t> mGeneration { NextGeneration() };
 	};
 
 	/// @brief ܹʵ
@@ -934,6 +6029,12 @@ namespace JFramework
 		using IArchitecture::RegisterSystem;
 		using IArchitecture::RegisterUtility;
 		using IArchitecture::SendCommand;
+		using IArchitecture::SendCommandAsync;
+		using IArchitecture::EnqueueCommand;
+		using IArchitecture::PostCommand;
+#if JFRAMEWORK_HAS_COROUTINES
+		using IArchitecture::SendCoroutineCommand;
+#endif
 		using IArchitecture::SendEvent;
 		using IArchitecture::UnRegisterEvent;
 
@@ -943,105 +6044,362 @@ namespace JFramework
 		void RegisterSystem(std::type_index typeId,
 			std::shared_ptr<ISystem> system) override
 		{
-			if (!system)
+			if (!system)
+			{
+				throw std::invalid_argument("System cannot be null");
+			}
+			system->SetArchitecture(shared_from_this());
+			system->SetArchitectureHandle(this);
+			mContainer->Register<ISystem>(typeId, system);
+			mSystemScheduler.Add(system.get());
+			if (mInitialized)
+			{
+				InitializeComponent(system);
+			}
+		}
+
+		std::shared_ptr<ISystem> GetSystem(std::type_index typeId) override
+		{
+			return mContainer->Get<ISystem>(typeId);
+		}
+
+		// ----------------------------------Model--------------------------------------//
+
+		void RegisterModel(std::type_index typeId,
+			std::shared_ptr<IModel> model) override
+		{
+			if (!model)
+			{
+				throw std::invalid_argument("Model cannot be null");
+			}
+			model->SetArchitecture(shared_from_this());
+			model->SetArchitectureHandle(this);
+			mContainer->Register<IModel>(typeId, model);
+			mSystemScheduler.Invalidate();
+			if (mInitialized)
+			{
+				InitializeComponent(model);
+			}
+		}
+
+		std::shared_ptr<IModel> GetModel(std::type_index typeId) override
+		{
+			return mContainer->Get<IModel>(typeId);
+		}
+
+		// ----------------------------------Utility--------------------------------------//
+
+		void RegisterUtility(std::type_index typeId,
+			std::shared_ptr<IUtility> utility) override
+		{
+			mContainer->Register<IUtility>(typeId, utility);
+		}
+
+		std::shared_ptr<IUtility> GetUtility(std::type_index typeId) override
+		{
+			return mContainer->Get<IUtility>(typeId);
+		}
+
+		uint64_t GetComponentGeneration() const override
+		{
+			return mContainer->GetGeneration();
+		}
+
+		// ----------------------------------Event--------------------------------------//
+
+		void RegisterEvent(std::type_index eventType,
+			ICanHandleEvent* handler) override
+		{
+			if (!handler)
+			{
+				throw std::invalid_argument("ICanHandleEvent cannot be null");
+			}
+			mEventBus->RegisterEvent(eventType, handler);
+		}
+
+		void UnRegisterEvent(std::type_index eventType,
+			ICanHandleEvent* handler) override
+		{
+			if (!handler)
+			{
+				throw std::invalid_argument("ICanHandleEvent cannot be null");
+			}
+			mEventBus->UnRegisterEvent(eventType, handler);
+		}
+
+	public:
+		// ʵ GetSharedPtr()
+		std::shared_ptr<IArchitecture> GetSharedFromThis() final
+		{
+			return shared_from_this();
+		}
+
+		// ----------------------------------Command--------------------------------------//
+
+		void SendCommand(std::unique_ptr<IJCommand> command) override
+		{
+			if (!command)
+			{
+				throw std::invalid_argument("ICommand cannot be null");
+			}
+			ExecuteCommand(*command);
+		}
+
+		void ExecuteCommand(IJCommand& command) override
+		{
+			JFRAMEWORK_TRACE_SCOPE("command", typeid(command).name());
+			JFRAMEWORK_ALLOCATION_SCOPE(Command);
+			auto* metrics = GetFrameworkMetrics();
+			LatencyScope latency(metrics ? &metrics->GetCommandLatency(typeid(command)) : nullptr);
+			// ִͬڼܹȻʹ÷ӵоüԭӲ
+			ArchitectureHandleScope handle(command, this);
+			// ־ʱлִгɹԳждʱ׷ӣ־ֻȡ־׷ӣ
+			// ԽִУд뼯ϵд⣬־˳޸ Model ˳һ
+			// ͷŶдٵȴ̣Կɹ fsync
+			bool outermost = JournalDepth() == 0 && mJournalEnabled.load(std::memory_order_acquire);
+			auto* serializable = outermost ? dynamic_cast<ISerializableCommand*>(&command) : nullptr;
+			std::shared_ptr<ICommandJournal> journal;
+			uint64_t sequence = 0;
 			{
-				throw std::invalid_argument("System cannot be null");
+				// д׷־汾֮ͷ
+				ModelAccessGuard guard;
+				ModelAccess access;
+				bool declared = command.DeclareModelAccess(access);
+				if (declared)
+					guard.Acquire(*this, access);
+				// ޸Ĺ Model 汾ʹزѯʧЧ
+				// ˶дϵֻд Modelδ޴ӵ֪дЩ Modelصصʹȫ Model
+				ModelAccessScope scope(true);
+				if (declared && !access.IsExclusive())
+					scope.SetVersionTargets(ResolveModels(access.GetWrites()));
+				if (outermost)
+				{
+					ExecuteOutermostCommand(command);
+					if (serializable)
+						sequence = AppendToJournal(*serializable, journal);
+				}
+				else
+					ExecuteUserCommand(command);
 			}
-			system->SetArchitecture(shared_from_this());
-			mContainer->Register<ISystem>(typeId, system);
-			if (mInitialized)
+			if (sequence != 0)
+				journal->Commit(sequence);
+		}
+
+		std::future<void> SendCommandAsync(std::unique_ptr<IJCommand> command) override
+		{
+			if (!command)
 			{
-				InitializeComponent(system);
+				throw std::invalid_argument("ICommand cannot be null");
 			}
+
+			auto key = command->GetOrderingKey();
+			auto promise = std::make_shared<std::promise<void>>();
+			auto future = promise->get_future();
+			// мܹãִ֤ڼܹ
+			auto task = [self = std::static_pointer_cast<Architecture>(shared_from_this()),
+							command = std::shared_ptr<IJCommand>(std::move(command)),
+							promise]()
+			{
+				try
+				{
+					self->ExecuteCommand(*command);
+					promise->set_value();
+				}
+				catch (...)
+				{
+					promise->set_exception(std::current_exception());
+				}
+			};
+
+			if (key == typeid(void))
+				GetTaskExecutor().Post(std::move(task));
+			else
+				GetTaskExecutor().Post(key, std::move(task));
+			return future;
 		}
 
-		std::shared_ptr<ISystem> GetSystem(std::type_index typeId) override
+		// ҵϵͳĹ߳ InitArchitecture ״첽ǰã0 ʾʹӲ߳
+		void SetAsyncThreadCount(size_t threadCount) { mAsyncThreadCount = threadCount; }
+
+		void EnqueueCommand(std::unique_ptr<IJCommand> command,
+			CommandPriority priority = CommandPriority::Normal) override
 		{
-			return mContainer->Get<ISystem>(typeId);
+			if (!command)
+			{
+				throw std::invalid_argument("ICommand cannot be null");
+			}
+			mCommandScheduler.Enqueue(std::move(command), priority);
 		}
 
-		// ----------------------------------Model--------------------------------------//
-
-		void RegisterModel(std::type_index typeId,
-			std::shared_ptr<IModel> model) override
+		void PostCommand(std::unique_ptr<IJCommand> command, Dispatcher& dispatcher) override
 		{
-			if (!model)
+			if (!command)
 			{
-				throw std::invalid_argument("Model cannot be null");
+				throw std::invalid_argument("ICommand cannot be null");
 			}
-			model->SetArchitecture(shared_from_this());
-			mContainer->Register<IModel>(typeId, model);
+			std::weak_ptr<IArchitecture> weak = shared_from_this();
+			dispatcher.Post([weak, command = std::shared_ptr<IJCommand>(std::move(command))]
+				{
+					if (auto self = weak.lock())
+						self->ExecuteCommand(*command);
+				});
+		}
+
+		// ÿ֡һΣԤִŶӵϵͳָЭ
+		void Tick(float deltaTime = 0.0f)
+		{
+			// ڶʱӵڱִ֡
+			mTimerService->Advance();
+			mCommandScheduler.Drain(mCommandBudget, [this](IJCommand& command) { ExecuteCommand(command); });
 			if (mInitialized)
 			{
-				InitializeComponent(model);
+				mSystemScheduler.Update(deltaTime,
+					[this]() -> TaskExecutor& { return GetTaskExecutor(); },
+					[this](std::type_index typeId) { return GetModel(typeId).get(); });
 			}
+#if JFRAMEWORK_HAS_COROUTINES
+			// Эָ̻ڼʹ Model ͬΪ޸
+			ModelAccessScope scope(true);
+			mCoroutineScheduler.Tick();
+#endif
 		}
 
-		std::shared_ptr<IModel> GetModel(std::type_index typeId) override
+		// ÿִ֡ӳʱԤ
+		void SetCommandBudget(std::chrono::nanoseconds budget) { mCommandBudget = budget; }
+
+		CommandSchedulerStats GetCommandSchedulerStats() { return mCommandScheduler.GetStats(); }
+
+		// ϵͳÿ֡µλ֣ͬһڵϵͳи
+		std::vector<std::vector<ISystem*>> GetSystemBatches()
 		{
-			return mContainer->Get<IModel>(typeId);
+			return mSystemScheduler.GetBatches([this](std::type_index typeId) { return GetModel(typeId).get(); });
 		}
 
-		// ----------------------------------Utility--------------------------------------//
+		// ----------------------------------Journal--------------------------------------//
 
-		void RegisterUtility(std::type_index typeId,
-			std::shared_ptr<IUtility> utility) override
+		// ־ִгɹ ISerializableCommand ׷ӵ journal
+		// ļʵּ JFrameworkJournal.hʱ滻ԭ־ִедִнʱ־
+		// д뼯ϲڶд Model ϻ⣬־˳޸˳һ
+		void EnableCommandJournal(std::shared_ptr<ICommandJournal> journal)
 		{
-			mContainer->Register<IUtility>(typeId, utility);
+			if (!journal)
+			{
+				throw std::invalid_argument("ICommandJournal cannot be null");
+			}
+			std::lock_guard<FrameworkMutex> lock(mJournalMutex);
+			// ԭ־ڽȴдʱ
+			journal.swap(mCommandJournal);
+			mJournalEnabled.store(true, std::memory_order_release);
 		}
 
-		std::shared_ptr<IUtility> GetUtility(std::type_index typeId) override
+		// ֹͣд־ڵȴ̵ͷ־
+		void DisableCommandJournal()
 		{
-			return mContainer->Get<IUtility>(typeId);
+			std::shared_ptr<ICommandJournal> journal;
+			std::lock_guard<FrameworkMutex> lock(mJournalMutex);
+			mJournalEnabled.store(false, std::memory_order_release);
+			journal.swap(mCommandJournal);
 		}
 
-		// ----------------------------------Event--------------------------------------//
+		// صָ־û滻ǰЧ
+		ICommandJournal* GetCommandJournal()
+		{
+			std::lock_guard<FrameworkMutex> lock(mJournalMutex);
+			return mCommandJournal.get();
+		}
 
-		void RegisterEvent(std::type_index eventType,
-			ICanHandleEvent* handler) override
+		// עɻطŵ_Ty ṩ static std::unique_ptr<_Ty> Deserialize(std::string_view)
+		template <typename _Ty>
+		void RegisterJournaledCommand(const std::string& name)
 		{
-			if (!handler)
+			static_assert(std::is_base_of_v<IJCommand, _Ty> && std::is_base_of_v<ISerializableCommand, _Ty>,
+				"_Ty must inherit from IJCommand and ISerializableCommand");
+			mJournalFactories[name] = [](std::string_view payload) -> std::unique_ptr<IJCommand>
 			{
-				throw std::invalid_argument("ICanHandleEvent cannot be null");
-			}
-			mEventBus->RegisterEvent(eventType, handler);
+				return _Ty::Deserialize(payload);
+			};
 		}
 
-		void UnRegisterEvent(std::type_index eventType,
-			ICanHandleEvent* handler) override
+		// עؽִһ־¼еطŵٴд־
+		void ReplayJournaledCommand(std::string_view name, std::string_view payload)
 		{
-			if (!handler)
+			auto it = mJournalFactories.find(std::string(name));
+			if (it == mJournalFactories.end())
 			{
-				throw std::invalid_argument("ICanHandleEvent cannot be null");
+				throw ComponentNotRegisteredException(std::string(name));
 			}
-			mEventBus->UnRegisterEvent(eventType, handler);
+			auto command = it->second(payload);
+			++JournalDepth();
+			try
+			{
+				ExecuteCommand(*command);
+			}
+			catch (...)
+			{
+				--JournalDepth();
+				throw;
+			}
+			--JournalDepth();
 		}
 
-	public:
-		// ʵ GetSharedPtr()
-		std::shared_ptr<IArchitecture> GetSharedFromThis() final
+		// ----------------------------------Undo--------------------------------------//
+
+		CommandHistory& GetCommandHistory() override { return mCommandHistory; }
+
+		// ----------------------------------Timer--------------------------------------//
+
+		TimerService& GetTimerService() override { return *mTimerService; }
+
+		// ----------------------------------Metrics--------------------------------------//
+
+		// ܰͼ¼¼/ѯʱĬϹرգעʼտͨ GetUtility<MetricsRegistry>() ȡ
+		void EnableFrameworkMetrics(bool enabled = true) { mFrameworkMetrics.store(enabled, std::memory_order_relaxed); }
+
+		MetricsRegistry* GetFrameworkMetrics() override
 		{
-			return shared_from_this();
+			return mFrameworkMetrics.load(std::memory_order_relaxed) ? mMetrics.get() : nullptr;
 		}
 
-		// ----------------------------------Command--------------------------------------//
+		// һοɳûпɳļ¼ʱ false
+		bool Undo() { return mCommandHistory.Undo(); }
 
-		void SendCommand(std::unique_ptr<IJCommand> command) override
+		bool Redo() { return mCommandHistory.Redo(); }
+
+#if JFRAMEWORK_HAS_COROUTINES
+		// ----------------------------------Coroutine--------------------------------------//
+
+		std::future<void> SendCoroutineCommand(std::unique_ptr<ICoroutineCommand> command) override
 		{
 			if (!command)
 			{
-				throw std::invalid_argument("ICommand cannot be null");
+				throw std::invalid_argument("ICoroutineCommand cannot be null");
 			}
 			command->SetArchitecture(shared_from_this());
-			command->Execute();
+
+			auto promise = std::make_shared<std::promise<void>>();
+			auto future = promise->get_future();
+			ModelAccessScope scope(true);
+			mCoroutineScheduler.Spawn(CompleteInto(RunOwned<ICoroutineCommand, void>(std::move(command)), promise));
+			return future;
 		}
 
+		CoroutineScheduler& GetCoroutineScheduler() override { return mCoroutineScheduler; }
+#endif
+
+		// ----------------------------------Query--------------------------------------//
+
+		QueryCache& GetQueryCache() override { return mQueryCache; }
+
+		void ClearQueryCache() { mQueryCache.Clear(); }
+
 		void SendEvent(std::shared_ptr<IEvent> event) override
 		{
 			if (!event)
 			{
 				throw std::invalid_argument("IEvent cannot be null");
 			}
+			if (auto* metrics = GetFrameworkMetrics())
+				metrics->GetEventCounter(typeid(*event)).Add();
 			mEventBus->SendEvent(event);
 		}
 
@@ -1056,6 +6414,14 @@ namespace JFramework
 
 			this->OnDeinit();
 
+			mQueryCache.Clear();
+			mCommandHistory.Clear();
+			mTimerService->Clear();
+#if JFRAMEWORK_HAS_COROUTINES
+			// δɵЭ̱٣ future  broken_promise 
+			mCoroutineScheduler.Clear();
+#endif
+
 			for (auto& model : mContainer->GetAll<IModel>())
 			{
 				UnInitializeComponent(model);
@@ -1074,6 +6440,9 @@ namespace JFramework
 
 			mInitialized = true;
 
+			// ҵϵͳڳʼʱõ߳״첽ʱ߳
+			GetTaskExecutor();
+
 			this->Init();
 
 			for (auto& model : mContainer->GetAll<IModel>())
@@ -1095,16 +6464,117 @@ namespace JFramework
 		{
 			mContainer = std::make_unique<IOCContainer>();
 			mEventBus = std::make_unique<EventBus>();
+			mMetrics = std::make_shared<MetricsRegistry>();
+			mContainer->Register<IUtility>(typeid(MetricsRegistry), std::static_pointer_cast<IUtility>(mMetrics));
 			mInitialized = false;
 		}
 
-		virtual ~Architecture() = default;
+		// ܱȼܹãӵо
+		virtual ~Architecture()
+		{
+			for (auto& model : mContainer->GetAll<IModel>())
+			{
+				model->SetArchitectureHandle(nullptr);
+			}
+			for (auto& system : mContainer->GetAll<ISystem>())
+			{
+				system->SetArchitectureHandle(nullptr);
+			}
+		}
 
 		virtual void Init() = 0;
 
 		virtual void OnDeinit() {}
 
+		//  InitArchitecture ״ʹʱִ
+		TaskExecutor& GetTaskExecutor() override
+		{
+			std::call_once(mTaskExecutorOnce, [this]
+				{
+					size_t count = mAsyncThreadCount;
+					if (count == 0)
+						count = std::max<size_t>(1, std::thread::hardware_concurrency());
+					mTaskExecutor = std::make_unique<TaskExecutor>(count);
+				});
+			return *mTaskExecutor;
+		}
+
 	private:
+		QueryCache mQueryCache;
+		CommandScheduler mCommandScheduler;
+		SystemScheduler mSystemScheduler;
+		CommandHistory mCommandHistory;
+		std::shared_ptr<TimerService> mTimerService = std::make_shared<TimerService>(); // Ƴ
+		std::shared_ptr<MetricsRegistry> mMetrics;
+		std::atomic<bool> mFrameworkMetrics { false };
+		FrameworkMutex mJournalMutex { "Architecture::mJournalMutex" };
+		std::atomic<bool> mJournalEnabled { false }; // δ־ʱ־
+		std::shared_ptr<ICommandJournal> mCommandJournal;
+		std::unordered_map<std::string, std::function<std::unique_ptr<IJCommand>(std::string_view)>> mJournalFactories;
+		std::chrono::nanoseconds mCommandBudget = std::chrono::milliseconds(2);
+		size_t mAsyncThreadCount = 0;
+		std::once_flag mTaskExecutorOnce;
+		std::unique_ptr<TaskExecutor> mTaskExecutor;
+#if JFRAMEWORK_HAS_COROUTINES
+		CoroutineScheduler mCoroutineScheduler { mTimerService };
+#endif
+
+		// Ƕִеֻ¼
+		static int& JournalDepth()
+		{
+			thread_local int depth = 0;
+			return depth;
+		}
+
+		std::vector<IModel*> ResolveModels(const std::vector<std::type_index>& types)
+		{
+			std::vector<IModel*> models;
+			for (auto& type : types)
+			{
+				if (auto model = GetModel(type))
+					models.push_back(model.get());
+			}
+			return models;
+		}
+
+		// ִû룬ܷ
+		static void ExecuteUserCommand(IJCommand& command)
+		{
+			JFRAMEWORK_ALLOCATION_SCOPE(None);
+			command.Execute();
+		}
+
+		// ִͬ͵ڱ¼
+		// 첽͵ִ߳УԵ¼
+		static void ExecuteOutermostCommand(IJCommand& command)
+		{
+			++JournalDepth();
+			try
+			{
+				ExecuteUserCommand(command);
+			}
+			catch (...)
+			{
+				--JournalDepth();
+				throw;
+			}
+			--JournalDepth();
+		}
+
+		// л־֮Уؼ¼ţ־ѱʱ 0
+		// ־ֻ ICommandJournal::Appendȡ
+		uint64_t AppendToJournal(const ISerializableCommand& command, std::shared_ptr<ICommandJournal>& journal)
+		{
+			thread_local std::string payload;
+			payload.clear();
+			command.Serialize(payload);
+			std::lock_guard<FrameworkMutex> lock(mJournalMutex);
+			if (!mCommandJournal)
+				return 0;
+			journal = mCommandJournal;
+			return journal->Append(command.GetJournalName(), payload);
+		}
+
 		template <typename _Ty>
 		void InitializeComponent(std::shared_ptr<_Ty> component)
 		{
@@ -1134,117 +6604,350 @@ namespace JFramework
 
 	// ================  ================
 
-	/// @brief Command
-	class AbstractCommand : public IJCommand
+	/// @brief ๲õļܹ
+	/// ӵʽñ weak_ptrӵоɼܹ֤Чܹڼ GetArchitecture ؿ
+	template <typename _Base>
+	class ArchitectureBinding : public _Base
 	{
-	private:
-		std::weak_ptr<IArchitecture> mArchitecture;
-
 	public:
 		std::weak_ptr<IArchitecture> GetArchitecture() const final
 		{
-			return mArchitecture;
+			return mArchitectureHandle ? mArchitectureHandle->weak_from_this() : mArchitecture;
 		}
 
-		void Execute() final { this->OnExecute(); }
+		IArchitecture* GetArchitectureHandle() const final { return mArchitectureHandle; }
 
-	public:
 		void SetArchitecture(std::shared_ptr<IArchitecture> architecture) final
 		{
 			mArchitecture = architecture;
 		}
 
+		void SetArchitectureHandle(IArchitecture* architecture) final
+		{
+			mArchitectureHandle = architecture;
+		}
+
+	private:
+		std::weak_ptr<IArchitecture> mArchitecture;
+		IArchitecture* mArchitectureHandle = nullptr;
+	};
+
+	/// @brief Command
+	class AbstractCommand : public ArchitectureBinding<IJCommand>
+	{
+	public:
+		void Execute() final { this->OnExecute(); }
+
 	protected:
 		virtual void OnExecute() = 0;
 	};
 
-	class AbstractModel : public IModel
+	/// @brief ɳĳCommand
+	/// ִڼʻд Model ǼǣOwnProperty BindableProperty ɹ۲켯ϵ޸ı¼Ϊܹĳʷ
+	/// ǶִеĿɳļ¼OnExecute ׳쳣ʱعѼ¼޸
+	class AbstractUndoableCommand : public ArchitectureBinding<IJCommand>
 	{
-	private:
-		std::weak_ptr<IArchitecture> mArchitecture;
-
 	public:
-		std::weak_ptr<IArchitecture> GetArchitecture() const final
+		void Execute() final
+		{
+			if (ChangeRecorder::IsRecording())
+			{
+				this->OnExecute();
+				return;
+			}
+
+			ChangeSet changeSet;
+			{
+				ChangeRecordScope recording(&changeSet);
+				// д Model ʹδͨ GetModel ȡ޸ͬ¼
+				ModelAccess access;
+				if (this->DeclareModelAccess(access))
+				{
+					if (auto arch = GetArchitecture().lock())
+					{
+						for (auto& type : access.GetWrites())
+						{
+							if (auto model = arch->GetModel(type))
+								changeSet.AddModel(model);
+						}
+					}
+				}
+				try
+				{
+					this->OnExecute();
+				}
+				catch (...)
+				{
+					ChangeRecordScope suspend(nullptr);
+					changeSet.Undo();
+					throw;
+				}
+			}
+
+			if (auto* handle = GetArchitectureHandle())
+			{
+				handle->GetCommandHistory().Push(std::move(changeSet));
+			}
+			else if (auto arch = GetArchitecture().lock())
+			{
+				arch->GetCommandHistory().Push(std::move(changeSet));
+			}
+		}
+
+	protected:
+		virtual void OnExecute() = 0;
+
+		// ¼ BindableProperty ֮״̬size Ϊ undo/redo ݵĹֽ
+		void RecordChange(std::function<void()> undo, std::function<void()> redo, size_t size = 0)
 		{
-			return mArchitecture;
+			ChangeRecorder::Record(std::make_unique<CallbackChange>(std::move(undo), std::move(redo), size));
 		}
+	};
 
+	class AbstractModel : public ArchitectureBinding<IModel>
+	{
+	public:
 		virtual void Init() final { this->OnInit(); }
 
 		void Deinit() final { this->OnDeinit(); }
 
 	private:
-		void SetArchitecture(std::shared_ptr<IArchitecture> architecture) final
-		{
-			mArchitecture = architecture;
-		}
+		using ArchitectureBinding::SetArchitecture;
+		using ArchitectureBinding::SetArchitectureHandle;
 
 	protected:
 		virtual void OnInit() = 0;
 		virtual void OnDeinit() = 0;
 	};
 
-	class AbstractSystem : public ISystem
+	class AbstractSystem : public ArchitectureBinding<ISystem>
 	{
-	private:
-		std::weak_ptr<IArchitecture> mArchitecture;
-
 	public:
-		std::weak_ptr<IArchitecture> GetArchitecture() const final
-		{
-			return mArchitecture;
-		}
-
 		virtual void Init() final { this->OnInit(); }
 
 		void Deinit() final { OnDeinit(); }
 
 		void HandleEvent(std::shared_ptr<IEvent> event) final { OnEvent(event); }
 
+		void Update(float deltaTime) final { OnUpdate(deltaTime); }
+
+		bool DeclareUpdate(ModelAccess& access) final { return OnDeclareUpdate(access); }
+
 	private:
-		void SetArchitecture(std::shared_ptr<IArchitecture> architecture) final
-		{
-			mArchitecture = architecture;
-		}
+		using ArchitectureBinding::SetArchitecture;
+		using ArchitectureBinding::SetArchitectureHandle;
 
 	protected:
 		virtual void OnInit() = 0;
 		virtual void OnDeinit() = 0;
 		virtual void OnEvent(std::shared_ptr<IEvent> event) = 0;
+
+		// Ҫÿ֡µϵͳдߣ OnDeclareUpdate д Model  true
+		virtual bool OnDeclareUpdate(ModelAccess& /*access*/) { return false; }
+		virtual void OnUpdate(float /*deltaTime*/) {}
 	};
 
 	class AbstractController : public IController
 	{
+	public:
+		// úע¼ dispatcher ̣߳ UI ̣߳ϴ RegisterEvent ֮ǰ
+		void SetEventDispatcher(Dispatcher* dispatcher) { mEventDispatcher = dispatcher; }
+
+		Dispatcher* GetEventDispatcher() const final { return mEventDispatcher; }
+
 	private:
 		void HandleEvent(std::shared_ptr<IEvent> event) final { OnEvent(event); }
 
+		Dispatcher* mEventDispatcher = nullptr;
+
 	protected:
 		virtual void OnEvent(std::shared_ptr<IEvent> event) = 0;
 	};
 
 	template <typename _Ty>
-	class AbstractQuery : public IQuery<_Ty>
+	class AbstractQuery : public ArchitectureBinding<IQuery<_Ty>>
 	{
-	private:
-		std::weak_ptr<IArchitecture> mArchitecture;
+	public:
+		_Ty Do() final { return OnDo(); }
+
+	protected:
+		virtual _Ty OnDo() = 0;
+	};
 
+#if JFRAMEWORK_HAS_COROUTINES
+	/// @brief Э
+	class AbstractCoroutineCommand : public ArchitectureBinding<ICoroutineCommand>
+	{
 	public:
-		std::weak_ptr<IArchitecture> GetArchitecture() const final
+		Task<void> ExecuteAsync() final { return this->OnExecuteAsync(); }
+
+	protected:
+		virtual Task<void> OnExecuteAsync() = 0;
+	};
+
+	/// @brief Э̲ѯ
+	template <typename _Ty>
+	class AbstractCoroutineQuery : public ArchitectureBinding<ICoroutineQuery<_Ty>>
+	{
+	public:
+		Task<_Ty> DoAsync() final { return this->OnDoAsync(); }
+
+	protected:
+		virtual Task<_Ty> OnDoAsync() = 0;
+	};
+#endif
+
+	// ================ ģʵ ================
+
+	template <typename _Query>
+	auto DoGuardedQuery(IArchitecture& architecture, _Query& query) -> decltype(query.Do())
+	{
+		JFRAMEWORK_TRACE_SCOPE("query", typeid(query).name());
+		JFRAMEWORK_ALLOCATION_SCOPE(Query);
+		auto* metrics = architecture.GetFrameworkMetrics();
+		LatencyScope latency(metrics ? &metrics->GetQueryLatency(typeid(query)) : nullptr);
+		ModelAccess access;
+		if (!query.DeclareModelAccess(access))
 		{
-			return mArchitecture;
+			// ѯִû룬ܷ
+			JFRAMEWORK_ALLOCATION_SCOPE(None);
+			return query.Do();
 		}
+		ModelAccessGuard guard;
+		guard.Acquire(architecture, access);
+		JFRAMEWORK_ALLOCATION_SCOPE(None);
+		return query.Do();
+	}
+
+	// ʱصֻ Tick ִУʱܹ٣صֱӳмָܹ
+	template <typename _Ty, typename... Args>
+	std::shared_ptr<TimerToken> IArchitecture::SendEventAfter(std::chrono::nanoseconds delay, Args&&... args)
+	{
+		static_assert(std::is_base_of_v<IEvent, _Ty>, "_Ty must inherit from IEvent");
+		std::shared_ptr<IEvent> event = std::make_shared<_Ty>(std::forward<Args>(args)...);
+		auto& timers = GetTimerService();
+		return timers.MakeToken(timers.Schedule(delay, [this, event] { SendEvent(event); }));
+	}
+
+	template <typename _Ty, typename... Args>
+	std::shared_ptr<TimerToken> IArchitecture::SendEventEvery(std::chrono::nanoseconds period, Args&&... args)
+	{
+		static_assert(std::is_base_of_v<IEvent, _Ty>, "_Ty must inherit from IEvent");
+		std::shared_ptr<IEvent> event = std::make_shared<_Ty>(std::forward<Args>(args)...);
+		auto& timers = GetTimerService();
+		return timers.MakeToken(timers.Schedule(period, [this, event] { SendEvent(event); }, period));
+	}
+
+	template <typename _Ty, typename... Args>
+	std::shared_ptr<TimerToken> IArchitecture::EnqueueCommandAfter(std::chrono::nanoseconds delay, Args&&... args)
+	{
+		static_assert(std::is_base_of_v<IJCommand, _Ty>, "_Ty must inherit from IJCommand");
+		// std::function Ҫɸƣ shared_ptr Уʱת
+		auto command = std::make_shared<std::unique_ptr<IJCommand>>(std::make_unique<_Ty>(std::forward<Args>(args)...));
+		auto& timers = GetTimerService();
+		return timers.MakeToken(timers.Schedule(delay, [this, command] { EnqueueCommand(std::move(*command)); }));
+	}
+
+	template <typename _Ty, typename... Args>
+	std::shared_ptr<TimerToken> IArchitecture::EnqueueCommandEvery(std::chrono::nanoseconds period, Args&&... args)
+	{
+		static_assert(std::is_base_of_v<IJCommand, _Ty>, "_Ty must inherit from IJCommand");
+		auto& timers = GetTimerService();
+		return timers.MakeToken(timers.Schedule(period,
+			[this, arguments = std::make_tuple(std::decay_t<Args>(std::forward<Args>(args))...)]
+			{
+				EnqueueCommand(std::apply([](const auto&... values) { return std::make_unique<_Ty>(values...); }, arguments));
+			},
+			period));
+	}
 
-		_Ty Do() final { return OnDo(); }
+	template <typename _Ty, typename... Args>
+	auto IArchitecture::SendCachedQuery(Args&&... args) -> decltype(std::declval<_Ty>().Do())
+	{
+		JFRAMEWORK_TRACE_SCOPE("cached_query", typeid(_Ty).name());
+		using Result = decltype(std::declval<_Ty>().Do());
+		using Key = std::tuple<std::decay_t<Args>...>;
 
-	public:
-		void SetArchitecture(std::shared_ptr<IArchitecture> architecture) final
+		auto& bucket = GetQueryCache().GetBucket<_Ty, Result, Key>();
+		Key key(args...);
+		if (auto cached = bucket.Find(key))
 		{
-			mArchitecture = architecture;
+			return std::move(*cached);
 		}
 
-	protected:
-		virtual _Ty OnDo() = 0;
-	};
+		// ׷м㣬¼ѯ Model 汾
+		ModelAccessScope scope(false);
+		Result result = this->SendQuery<_Ty>(std::forward<Args>(args)...);
+		bucket.Store(std::move(key), result, scope.Collect(), GetQueryCache().GetMaxEntriesPerQuery());
+		return result;
+	}
+
+	template <typename... _Queries>
+	auto IArchitecture::SendQueries(std::unique_ptr<_Queries>... queries)
+		-> std::tuple<decltype(std::declval<_Queries>().Do())...>
+	{
+		static_assert(sizeof...(_Queries) > 0, "SendQueries requires at least one query");
+		static_assert((!std::is_void_v<decltype(std::declval<_Queries>().Do())> && ...),
+			"SendQueries does not support void queries");
+
+		if (((!queries) || ...))
+		{
+			throw std::invalid_argument("Query cannot be null");
+		}
+
+		auto self = GetSharedFromThis();
+		auto& executor = GetTaskExecutor();
+		// ̻߳ȴ̳߳е߳ͷǰһֱȴ
+		bool parallel = !IsHoldingModelAccess();
+		auto start = [&](auto query)
+		{
+			using Query = typename decltype(query)::element_type;
+			using Result = decltype(std::declval<Query>().Do());
+
+			bool readOnly = query->IsReadOnly();
+			auto promise = std::make_shared<std::promise<Result>>();
+			auto future = promise->get_future();
+			auto run = [self, promise, query = std::shared_ptr<Query>(std::move(query))]()
+			{
+				try
+				{
+					ArchitectureHandleScope handle(*query, self.get());
+					promise->set_value(DoGuardedQuery(*self, *query));
+				}
+				catch (...)
+				{
+					promise->set_exception(std::current_exception());
+				}
+			};
+
+			if (readOnly && parallel)
+				executor.Post(std::move(run));
+			else
+				run();
+			return future;
+		};
+
+		// ųʼ֤˳
+		std::tuple<std::future<decltype(std::declval<_Queries>().Do())>...> futures { start(std::move(queries))... };
+		std::apply([&](auto&... future) { (executor.HelpWhileWaiting(future), ...); }, futures);
+		return std::apply([](auto&... future) { return std::make_tuple(future.get()...); }, futures);
+	}
+#if JFRAMEWORK_HAS_COROUTINES
+	template <typename _Ty, typename... Args>
+	auto IArchitecture::SendCoroutineQuery(Args&&... args)
+		-> std::future<typename decltype(std::declval<_Ty>().DoAsync())::value_type>
+	{
+		using Result = typename decltype(std::declval<_Ty>().DoAsync())::value_type;
+
+		auto query = std::make_unique<_Ty>(std::forward<Args>(args)...);
+		query->SetArchitecture(GetSharedFromThis());
+
+		auto promise = std::make_shared<std::promise<Result>>();
+		auto future = promise->get_future();
+		GetCoroutineScheduler().Spawn(CompleteInto(RunOwned<_Ty, Result>(std::move(query)), promise));
+		return future;
+	}
+#endif
 }; // namespace JFramework
 
 #endif // !_JFRAMEWORK_
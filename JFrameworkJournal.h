@@ -0,0 +1,548 @@
+/****************************************************************************
+ * Copyright (c) 2025 zjlove1989
+
+ * https://github.com/zjlove1989/JFramework
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in
+ * all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ * THE SOFTWARE.
+ ****************************************************************************/
+
+#ifndef JFRAMEWORK_JOURNAL
+#define JFRAMEWORK_JOURNAL
+
+// ļ־׷д롢ύ fsyncطʱͨڴӳȡ
+// ƽ̨ļӿֻڰͷļķ뵥Ԫ
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <cstring>
+#include <filesystem>
+
+#include "JFramework.h"
+
+namespace JFramework
+{
+	/// @brief ־־ûʽ
+	enum class JournalDurability
+	{
+		Async, // ̨߳д벢 fsyncSendCommand ȴ
+		Sync   // SendCommand ȴ fsync ɣ͵һ fsync
+	};
+
+	enum class JournalRecordKind : uint8_t
+	{
+		Command = 0,
+		Snapshot = 1
+	};
+
+	struct JournalReplayResult
+	{
+		size_t replayed = 0;      // طŵ
+		std::string snapshotTag;  // һձǵıǩûпʱΪ
+		bool truncated = false;   // ־βڲļ¼д;
+	};
+
+	/// @brief ־ļʽ
+	/// ļͷΪ 8 ֽħ֮ÿ¼Ϊ 12 ֽͷ +  + 
+	/// ¼ͷܳ(uint32) У(uint32) Ƴ(uint16) (uint8) (uint8)
+	struct JournalFormat
+	{
+		static constexpr char MagicBytes[8] = { 'J', 'F', 'C', 'J', 'O', 'U', 'R', '1' };
+		static constexpr size_t HeaderSize = 12;
+
+		// FNV-1a
+		static uint32_t Checksum(JournalRecordKind kind, std::string_view name, std::string_view payload)
+		{
+			uint32_t hash = 2166136261u;
+			auto mix = [&](const char* data, size_t size)
+			{
+				for (size_t i = 0; i < size; ++i)
+				{
+					hash ^= static_cast<uint8_t>(data[i]);
+					hash *= 16777619u;
+				}
+			};
+			char k = static_cast<char>(kind);
+			mix(&k, 1);
+			mix(name.data(), name.size());
+			mix(payload.data(), payload.size());
+			return hash;
+		}
+
+		static void Encode(std::string& out, JournalRecordKind kind, std::string_view name, std::string_view payload)
+		{
+			if (name.size() > UINT16_MAX || name.size() + payload.size() > UINT32_MAX)
+			{
+				throw CommandJournalException("record too large");
+			}
+			char header[HeaderSize] = {};
+			uint32_t size = static_cast<uint32_t>(name.size() + payload.size());
+			uint32_t checksum = Checksum(kind, name, payload);
+			uint16_t nameLength = static_cast<uint16_t>(name.size());
+			std::memcpy(header, &size, 4);
+			std::memcpy(header + 4, &checksum, 4);
+			std::memcpy(header + 8, &nameLength, 2);
+			header[10] = static_cast<char>(kind);
+			out.append(header, HeaderSize);
+			out.append(name.data(), name.size());
+			out.append(payload.data(), payload.size());
+		}
+	};
+
+	/// @brief ֻڴӳļ
+	class MappedFile
+	{
+	public:
+		explicit MappedFile(const std::string& path)
+		{
+#if defined(_WIN32)
+			mFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr,
+				OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (mFile == INVALID_HANDLE_VALUE)
+			{
+				throw CommandJournalException("cannot open " + path);
+			}
+			LARGE_INTEGER size;
+			GetFileSizeEx(mFile, &size);
+			mSize = static_cast<size_t>(size.QuadPart);
+			if (mSize > 0)
+			{
+				mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mMapping)
+					mData = static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+				if (!mData)
+				{
+					Close();
+					throw CommandJournalException("cannot map " + path);
+				}
+			}
+#else
+			mFile = open(path.c_str(), O_RDONLY);
+			if (mFile < 0)
+			{
+				throw CommandJournalException("cannot open " + path);
+			}
+			mSize = static_cast<size_t>(lseek(mFile, 0, SEEK_END));
+			if (mSize > 0)
+			{
+				void* data = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+				if (data == MAP_FAILED)
+				{
+					Close();
+					throw CommandJournalException("cannot map " + path);
+				}
+				mData = static_cast<const char*>(data);
+			}
+#endif
+		}
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		~MappedFile() { Close(); }
+
+		const char* Data() const { return mData; }
+		size_t Size() const { return mSize; }
+
+	private:
+		void Close()
+		{
+#if defined(_WIN32)
+			if (mData)
+				UnmapViewOfFile(mData);
+			if (mMapping)
+				CloseHandle(mMapping);
+			if (mFile != INVALID_HANDLE_VALUE)
+				CloseHandle(mFile);
+			mMapping = nullptr;
+			mFile = INVALID_HANDLE_VALUE;
+#else
+			if (mData)
+				munmap(const_cast<char*>(mData), mSize);
+			if (mFile >= 0)
+				close(mFile);
+			mFile = -1;
+#endif
+			mData = nullptr;
+		}
+
+#if defined(_WIN32)
+		HANDLE mFile = INVALID_HANDLE_VALUE;
+		HANDLE mMapping = nullptr;
+#else
+		int mFile = -1;
+#endif
+		const char* mData = nullptr;
+		size_t mSize = 0;
+	};
+
+	/// @brief ־ȡͨڴӳ˳ɨ¼
+	/// Уʧܵļ¼ֹͣΪ־ĩβ
+	class CommandJournalReader
+	{
+	public:
+		struct Record
+		{
+			JournalRecordKind kind;
+			std::string_view name;
+			std::string_view payload;
+		};
+
+		explicit CommandJournalReader(const std::string& path)
+			: mFile(path)
+		{
+			// дļͷʱļͷǰ׺ΪûЧ¼־
+			size_t headerSize = std::min(mFile.Size(), sizeof(JournalFormat::MagicBytes));
+			if (headerSize > 0 && std::memcmp(mFile.Data(), JournalFormat::MagicBytes, headerSize) != 0)
+			{
+				throw CommandJournalException("not a command journal: " + path);
+			}
+		}
+
+		//  offset ʼε fn(const Record&)һЧ¼֮ƫ
+		template <typename _Fn>
+		size_t ForEach(_Fn&& fn, size_t offset = sizeof(JournalFormat::MagicBytes)) const
+		{
+			const char* data = mFile.Data();
+			size_t size = mFile.Size();
+			if (size < sizeof(JournalFormat::MagicBytes))
+				return 0;
+
+			while (size - offset >= JournalFormat::HeaderSize)
+			{
+				uint32_t length;
+				uint32_t checksum;
+				uint16_t nameLength;
+				std::memcpy(&length, data + offset, 4);
+				std::memcpy(&checksum, data + offset + 4, 4);
+				std::memcpy(&nameLength, data + offset + 8, 2);
+				auto kind = static_cast<JournalRecordKind>(data[offset + 10]);
+				if (length < nameLength || size - offset - JournalFormat::HeaderSize < length)
+					break;
+
+				const char* body = data + offset + JournalFormat::HeaderSize;
+				Record record { kind, std::string_view(body, nameLength),
+					std::string_view(body + nameLength, length - nameLength) };
+				if (JournalFormat::Checksum(kind, record.name, record.payload) != checksum)
+					break;
+
+				fn(record);
+				offset += JournalFormat::HeaderSize + length;
+			}
+			return offset;
+		}
+
+		// Чݵĩβƫƣֽ֮Ϊд;µĲȱ¼
+		size_t GetValidSize() const
+		{
+			return ForEach([](const Record&) {});
+		}
+
+		size_t GetFileSize() const { return mFile.Size(); }
+
+	private:
+		MappedFile mFile;
+	};
+
+	/// @brief ׷д־
+	/// ֻ߳ѱļ¼׷ӵڴ滺壻̨߳һдеȫ¼ fsyncύ
+	class CommandJournal : public ICommandJournal
+	{
+	public:
+		// 򿪻򴴽־־βĲȱ¼ᱻض
+		CommandJournal(const std::string& path, JournalDurability durability = JournalDurability::Async)
+			: mDurability(durability)
+		{
+			size_t validSize = 0;
+			std::error_code error;
+			if (std::filesystem::exists(path, error) && std::filesystem::file_size(path, error) > 0)
+			{
+				size_t fileSize = 0;
+				{
+					CommandJournalReader reader(path);
+					validSize = reader.GetValidSize();
+					fileSize = reader.GetFileSize();
+				}
+				if (validSize < fileSize)
+					std::filesystem::resize_file(path, validSize);
+			}
+
+			// ضɺٴ򿪣֮Ĳʧʱرļй©
+			OpenLog(path);
+			try
+			{
+				if (validSize == 0)
+					mPending.append(JournalFormat::MagicBytes, sizeof(JournalFormat::MagicBytes));
+				mWriter = std::thread([this] { Run(); });
+			}
+			catch (...)
+			{
+				CloseLog();
+				throw;
+			}
+		}
+
+		CommandJournal(const CommandJournal&) = delete;
+		CommandJournal& operator=(const CommandJournal&) = delete;
+
+		// дͬʣ¼ر
+		~CommandJournal() override
+		{
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStop = true;
+			}
+			mWake.notify_one();
+			mWriter.join();
+			CloseLog();
+		}
+
+		// ׷һ¼ţȴ̣Sync ģʽµ÷ Commit
+		// ܹԳждʱ׷ӡͷźύдͬһ Model ִ˳ҹ fsync
+		uint64_t Append(std::string_view name, std::string_view payload) override
+		{
+			return Append(JournalRecordKind::Command, name, payload);
+		}
+
+		// Sync ģʽµȴŲ sequence ļ¼̣Async ģʽֱӷ
+		void Commit(uint64_t sequence) override
+		{
+			if (mDurability != JournalDurability::Sync)
+				return;
+			std::unique_lock<std::mutex> lock(mMutex);
+			WaitDurable(lock, sequence);
+		}
+
+		// дձǣ÷ڱ Model պãطŴһ֮ʼ
+		void MarkSnapshot(std::string_view tag) override
+		{
+			Commit(Append(JournalRecordKind::Snapshot, {}, tag));
+		}
+
+		// ȴ׷ӵļ¼ȫ
+		void Flush() override
+		{
+			std::unique_lock<std::mutex> lock(mMutex);
+			WaitDurable(lock, mAppended);
+		}
+
+		CommandJournalStats GetStats() override
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mStats;
+		}
+
+	private:
+		uint64_t Append(JournalRecordKind kind, std::string_view name, std::string_view payload)
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			return Enqueue(kind, name, payload);
+		}
+
+		// ÷ mMutex
+		uint64_t Enqueue(JournalRecordKind kind, std::string_view name, std::string_view payload)
+		{
+			if (mFailed)
+			{
+				throw CommandJournalException("write failed");
+			}
+			JournalFormat::Encode(mPending, kind, name, payload);
+			++mStats.recordsAppended;
+			mWake.notify_one();
+			return ++mAppended;
+		}
+
+		void WaitDurable(std::unique_lock<std::mutex>& lock, uint64_t sequence)
+		{
+			mDurableChanged.wait(lock, [&] { return mDurable >= sequence || mFailed; });
+			if (mFailed)
+			{
+				throw CommandJournalException("write failed");
+			}
+		}
+
+		void Run()
+		{
+			std::string batch;
+			std::unique_lock<std::mutex> lock(mMutex);
+			for (;;)
+			{
+				mWake.wait(lock, [this] { return mStop || !mPending.empty(); });
+				if (mPending.empty())
+					break;
+
+				batch.swap(mPending);
+				uint64_t sequence = mAppended;
+				lock.unlock();
+
+				bool ok = WriteLog(batch) && SyncLog();
+
+				lock.lock();
+				if (ok)
+				{
+					mDurable = sequence;
+					mStats.bytesWritten += batch.size();
+					++mStats.syncCount;
+				}
+				else
+				{
+					mFailed = true;
+				}
+				batch.clear();
+				mDurableChanged.notify_all();
+				if (mFailed)
+					break;
+			}
+		}
+
+#if defined(_WIN32)
+		void OpenLog(const std::string& path)
+		{
+			mFile = CreateFileA(path.c_str(), FILE_APPEND_DATA, FILE_SHARE_READ, nullptr,
+				OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (mFile == INVALID_HANDLE_VALUE)
+			{
+				throw CommandJournalException("cannot open " + path);
+			}
+		}
+
+		bool WriteLog(const std::string& data)
+		{
+			size_t written = 0;
+			while (written < data.size())
+			{
+				DWORD count = 0;
+				DWORD chunk = static_cast<DWORD>(std::min<size_t>(data.size() - written, 1u << 30));
+				if (!::WriteFile(mFile, data.data() + written, chunk, &count, nullptr))
+					return false;
+				written += count;
+			}
+			return true;
+		}
+
+		bool SyncLog() { return FlushFileBuffers(mFile) != 0; }
+
+		void CloseLog()
+		{
+			if (mFile != INVALID_HANDLE_VALUE)
+				CloseHandle(mFile);
+			mFile = INVALID_HANDLE_VALUE;
+		}
+
+		HANDLE mFile = INVALID_HANDLE_VALUE;
+#else
+		void OpenLog(const std::string& path)
+		{
+			mFile = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+			if (mFile < 0)
+			{
+				throw CommandJournalException("cannot open " + path);
+			}
+		}
+
+		bool WriteLog(const std::string& data)
+		{
+			size_t written = 0;
+			while (written < data.size())
+			{
+				ssize_t count = write(mFile, data.data() + written, data.size() - written);
+				if (count < 0)
+					return false;
+				written += static_cast<size_t>(count);
+			}
+			return true;
+		}
+
+		bool SyncLog()
+		{
+#if defined(__APPLE__)
+			return fsync(mFile) == 0;
+#else
+			return fdatasync(mFile) == 0;
+#endif
+		}
+
+		void CloseLog()
+		{
+			if (mFile >= 0)
+				close(mFile);
+			mFile = -1;
+		}
+
+		int mFile = -1;
+#endif
+
+		JournalDurability mDurability;
+		std::mutex mMutex;
+		std::condition_variable mWake;
+		std::condition_variable mDurableChanged;
+		std::string mPending;
+		uint64_t mAppended = 0;
+		uint64_t mDurable = 0;
+		bool mStop = false;
+		bool mFailed = false;
+		CommandJournalStats mStats;
+		std::thread mWriter;
+	};
+
+	/// @brief ط־һձ֮طŵٴд־
+	inline JournalReplayResult ReplayCommandJournal(Architecture& architecture, const std::string& path)
+	{
+		JournalReplayResult result;
+		CommandJournalReader reader(path);
+		if (reader.GetFileSize() == 0)
+			return result;
+
+		size_t start = sizeof(JournalFormat::MagicBytes);
+		size_t offset = start;
+		size_t end = reader.ForEach([&](const CommandJournalReader::Record& record)
+			{
+				offset += JournalFormat::HeaderSize + record.name.size() + record.payload.size();
+				if (record.kind == JournalRecordKind::Snapshot)
+				{
+					start = offset;
+					result.snapshotTag.assign(record.payload);
+				}
+			});
+		result.truncated = end < reader.GetFileSize();
+
+		reader.ForEach([&](const CommandJournalReader::Record& record)
+			{
+				if (record.kind != JournalRecordKind::Command)
+					return;
+				architecture.ReplayJournaledCommand(record.name, record.payload);
+				++result.replayed;
+			},
+			start);
+		return result;
+	}
+}; // namespace JFramework
+
+#endif // !JFRAMEWORK_JOURNAL
@@ -1,10 +1,21 @@
 #include "pch.h"
+// ڱ׷ٵ㡢ͳУ׷Ĭʱر
+#define JFRAMEWORK_ENABLE_TRACING 1
+#define JFRAMEWORK_ENABLE_ALLOCATION_TRACKING 1
+#define JFRAMEWORK_ENABLE_LOCK_PROFILING 1
 #include "../JFramework.h"
+#include "../JFrameworkJournal.h"
+#include <array>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
 #include <thread>
 
 using namespace JFramework;
 
+// ʹÿṩȫ operator new/deleteջϲѯͳƲԹ
+JFRAMEWORK_DEFINE_ALLOCATION_HOOKS()
+
 // ========== 쳣 ==========
 TEST(ExceptionTest, ArchitectureNotSetException)
 {
@@ -786,6 +797,439 @@ TEST(BindablePropertyTest, MoveAssignAndMoveConstruct)
 	EXPECT_EQ(prop3.GetValue(), 2);
 }
 
+TEST(BindablePropertyTest, ObserversShareValueReference)
+{
+	BindableProperty<std::vector<int>> prop;
+	const std::vector<int>* p1 = nullptr;
+	const std::vector<int>* p2 = nullptr;
+	auto u1 = prop.Register([&](const std::vector<int>& v) { p1 = &v; });
+	auto u2 = prop.Register([&](const std::vector<int>& v) { p2 = &v; });
+	prop.SetValue(std::vector<int>{ 1, 2, 3 });
+	// й۲õĶڲֵãûп
+	EXPECT_EQ(p1, &prop.GetValue());
+	EXPECT_EQ(p2, &prop.GetValue());
+}
+
+TEST(BindablePropertyTest, SetValueMovesRvalue)
+{
+	BindableProperty<std::string> prop;
+	std::string observed;
+	auto u = prop.Register([&](const std::string& v) { observed = v; });
+	std::string value(64, 'x');
+	const char* buffer = value.data();
+	prop.SetValue(std::move(value));
+	EXPECT_EQ(prop.GetValue().data(), buffer);
+	EXPECT_EQ(observed, std::string(64, 'x'));
+}
+
+TEST(BindablePropertyTest, ModifyNotifiesObservers)
+{
+	BindableProperty<std::vector<int>> prop;
+	size_t observedSize = 0;
+	auto u = prop.Register([&](const std::vector<int>& v) { observedSize = v.size(); });
+	prop.Modify([](std::vector<int>& v) { v.push_back(1); });
+	EXPECT_EQ(observedSize, 1);
+	EXPECT_EQ(prop.GetValue().size(), 1);
+}
+
+TEST(BindablePropertyTest, ModifyReturningFalseSkipsNotification)
+{
+	BindableProperty<int> prop(1);
+	int count = 0;
+	auto u = prop.Register([&](const int&) { ++count; });
+	prop.Modify([](int&) { return false; });
+	EXPECT_EQ(count, 0);
+	prop.Modify([](int& v)
+		{
+			v = 2;
+			return true;
+		});
+	EXPECT_EQ(count, 1);
+	EXPECT_EQ(prop.GetValue(), 2);
+}
+
+TEST(BindablePropertyTest, ThrottleNotifiesLatestValueOncePerInterval)
+{
+	using namespace std::chrono;
+	BindableProperty<int> prop(0);
+	std::vector<int> observed;
+	auto u = prop.Register([&](const int& v) { observed.push_back(v); },
+		NotifyPolicy::Throttle(milliseconds(100)));
+
+	for (int i = 1; i <= 5; ++i)
+		prop.SetValue(i);
+	// дʱ֪ͨ۲
+	EXPECT_TRUE(observed.empty());
+
+	auto t0 = steady_clock::now();
+	prop.Tick(t0);
+	ASSERT_EQ(observed.size(), 1);
+	EXPECT_EQ(observed.back(), 5);
+
+	prop.SetValue(6);
+	prop.Tick(t0 + milliseconds(50));
+	EXPECT_EQ(observed.size(), 1);
+	prop.Tick(t0 + milliseconds(100));
+	ASSERT_EQ(observed.size(), 2);
+	EXPECT_EQ(observed.back(), 6);
+
+	// û±仯ʱظ֪ͨ
+	prop.Tick(t0 + milliseconds(300));
+	EXPECT_EQ(observed.size(), 2);
+}
+
+TEST(BindablePropertyTest, DebounceNotifiesAfterQuietPeriod)
+{
+	using namespace std::chrono;
+	BindableProperty<int> prop(0);
+	std::vector<int> observed;
+	auto u = prop.Register([&](const int& v) { observed.push_back(v); },
+		NotifyPolicy::Debounce(milliseconds(50)));
+
+	auto t0 = steady_clock::now();
+	prop.SetValue(1);
+	prop.Tick(t0);
+	prop.Tick(t0 + milliseconds(30));
+	EXPECT_TRUE(observed.empty());
+
+	// Ĭٴα仯¼ʱ
+	prop.SetValue(2);
+	prop.Tick(t0 + milliseconds(40));
+	prop.Tick(t0 + milliseconds(80));
+	EXPECT_TRUE(observed.empty());
+
+	prop.Tick(t0 + milliseconds(90));
+	ASSERT_EQ(observed.size(), 1);
+	EXPECT_EQ(observed.back(), 2);
+}
+
+TEST(BindablePropertyTest, ImmediateAndThrottledObserversCoexist)
+{
+	using namespace std::chrono;
+	BindableProperty<int> prop(0);
+	int immediateCount = 0, throttledCount = 0;
+	auto u1 = prop.Register([&](const int&) { ++immediateCount; });
+	auto u2 = prop.Register([&](const int&) { ++throttledCount; },
+		NotifyPolicy::Throttle(seconds(1)));
+	for (int i = 1; i <= 10; ++i)
+		prop.SetValue(i);
+	prop.Tick();
+	EXPECT_EQ(immediateCount, 10);
+	EXPECT_EQ(throttledCount, 1);
+}
+
+TEST(BindablePropertyTest, DispatcherCoalescesToLatestValue)
+{
+	BindableProperty<int> prop(0);
+	Dispatcher uiDispatcher;
+	std::vector<int> observed;
+	std::thread::id callbackThread;
+	auto u = prop.Register([&](const int& v)
+		{
+			observed.push_back(v);
+			callbackThread = std::this_thread::get_id();
+		},
+		&uiDispatcher);
+
+	std::thread writer([&]
+		{
+			for (int i = 1; i <= 1000; ++i)
+				prop.SetValue(i);
+		});
+	writer.join();
+
+	// дִ̲߳лصֻһִ֪ͨ
+	EXPECT_TRUE(observed.empty());
+	EXPECT_EQ(uiDispatcher.PendingCount(), 1);
+
+	EXPECT_EQ(uiDispatcher.Pump(), 1);
+	ASSERT_EQ(observed.size(), 1);
+	EXPECT_EQ(observed.back(), 1000);
+	EXPECT_EQ(callbackThread, std::this_thread::get_id());
+
+	// ͶݺٴͶ
+	prop.SetValue(1001);
+	uiDispatcher.Pump();
+	EXPECT_EQ(observed.back(), 1001);
+}
+
+TEST(BindablePropertyTest, DispatcherSkipsUnRegisteredObserver)
+{
+	Dispatcher uiDispatcher;
+	int count = 0;
+	BindableProperty<int> prop(0);
+	auto u = prop.Register([&](const int&) { ++count; }, &uiDispatcher);
+	prop.SetValue(1);
+	u->UnRegister();
+	uiDispatcher.Pump();
+	EXPECT_EQ(count, 0);
+}
+
+TEST(BindablePropertyTest, DispatcherAfterPropertyDestroyed)
+{
+	Dispatcher uiDispatcher;
+	int count = 0;
+	std::shared_ptr<BindablePropertyUnRegister<int>> u;
+	{
+		BindableProperty<int> prop(0);
+		u = prop.Register([&](const int&) { ++count; }, &uiDispatcher);
+		prop.SetValue(1);
+	}
+	uiDispatcher.Pump();
+	EXPECT_EQ(count, 0);
+	EXPECT_NO_THROW(u->UnRegister());
+}
+
+TEST(BindablePropertyTest, JournalDisabledByDefault)
+{
+	BindableProperty<int> prop(0);
+	prop.SetValue(1);
+	EXPECT_FALSE(prop.IsJournalEnabled());
+	EXPECT_TRUE(prop.DumpJournal().empty());
+}
+
+TEST(BindablePropertyTest, JournalRecordsOldAndNewValues)
+{
+	BindableProperty<std::string> prop("a");
+	prop.EnableJournal(8);
+	prop.SetValue("b");
+	prop.SetValueWithoutEvent("c");
+	prop.Modify([](std::string& v) { v += "d"; });
+	// δ޸ĵ Modify ¼
+	prop.Modify([](std::string&) { return false; });
+
+	auto records = prop.DumpJournal();
+	ASSERT_EQ(records.size(), 3);
+	EXPECT_EQ(records[0].oldValue, "a");
+	EXPECT_EQ(records[0].newValue, "b");
+	EXPECT_EQ(records[1].oldValue, "b");
+	EXPECT_EQ(records[1].newValue, "c");
+	EXPECT_EQ(records[2].oldValue, "c");
+	EXPECT_EQ(records[2].newValue, "cd");
+	EXPECT_EQ(records[2].sequence, 2);
+	EXPECT_EQ(records[0].threadId, std::this_thread::get_id());
+	EXPECT_LE(records[0].timestamp, records[2].timestamp);
+}
+
+TEST(BindablePropertyTest, JournalKeepsMostRecentEntries)
+{
+	BindableProperty<int> prop(0);
+	prop.EnableJournal(4);
+	std::thread::id writerId;
+	std::thread writer([&]
+		{
+			writerId = std::this_thread::get_id();
+			for (int i = 1; i <= 10; ++i)
+				prop.SetValue(i);
+		});
+	writer.join();
+
+	auto records = prop.DumpJournal();
+	ASSERT_EQ(records.size(), 4);
+	EXPECT_EQ(records.front().newValue, 7);
+	EXPECT_EQ(records.back().newValue, 10);
+	EXPECT_EQ(records.back().sequence, 9);
+	EXPECT_EQ(records.back().threadId, writerId);
+}
+
+TEST(BindablePropertyTest, JournalKeepsEntriesWhenModifyFails)
+{
+	BindableProperty<int> prop(0);
+	prop.EnableJournal(2);
+	prop.SetValue(1);
+	prop.SetValue(2);
+
+	// λܾ׳쳣޸Ĳܸɵļ¼
+	prop.Modify([](int&) { return false; });
+	EXPECT_THROW(prop.Modify([](int&) { throw std::runtime_error("rejected"); }), std::runtime_error);
+
+	auto records = prop.DumpJournal();
+	ASSERT_EQ(records.size(), 2);
+	EXPECT_EQ(records[0].oldValue, 0);
+	EXPECT_EQ(records[0].newValue, 1);
+	EXPECT_EQ(records[1].oldValue, 1);
+	EXPECT_EQ(records[1].newValue, 2);
+	EXPECT_EQ(prop.GetValue(), 2);
+}
+
+TEST(BindablePropertyTest, ModifyRestoresValueWhenCallbackThrows)
+{
+	BindableProperty<std::string> prop("a");
+	prop.EnableJournal(4);
+	int count = 0;
+	auto u = prop.Register([&](const std::string&) { ++count; });
+
+	EXPECT_THROW(prop.Modify([](std::string& v)
+		{
+			v = "partial";
+			throw std::runtime_error("failed");
+		}), std::runtime_error);
+	EXPECT_EQ(prop.GetValue(), "a");
+	EXPECT_EQ(count, 0);
+	EXPECT_TRUE(prop.DumpJournal().empty());
+}
+
+TEST(BindablePropertyTest, ModifyCommitsWhenCallbackReturnsFalseAfterWriting)
+{
+	BindableProperty<int> prop(0);
+	prop.EnableJournal(2);
+	prop.SetValue(1);
+	prop.SetValue(2);
+	int last = -1;
+	auto u = prop.Register([&](const int& v) { last = v; });
+
+	//  false ȴĶֵ԰¼֪ͨ
+	prop.Modify([](int& v)
+		{
+			v = 99;
+			return false;
+		});
+	EXPECT_EQ(last, 99);
+	auto records = prop.DumpJournal();
+	ASSERT_EQ(records.size(), 2);
+	EXPECT_EQ(records[0].oldValue, 1);
+	EXPECT_EQ(records[1].oldValue, 2);
+	EXPECT_EQ(records[1].newValue, 99);
+}
+
+// ========== BindableList / BindableMap  ==========
+
+TEST(BindableListTest, AddInsertRemoveDeltas)
+{
+	BindableList<std::string> list;
+	std::vector<std::pair<CollectionChangeAction, size_t>> changes;
+	std::string lastValue;
+	auto u = list.Register([&](const ListChange<std::string>& c)
+		{
+			changes.emplace_back(c.action, c.index);
+			if (c.value)
+				lastValue = *c.value;
+		});
+
+	list.Add("a");
+	list.Add("c");
+	list.Insert(1, "b");
+	EXPECT_EQ(list.Size(), 3);
+	EXPECT_EQ(list[1], "b");
+	EXPECT_EQ(changes.back(), std::make_pair(CollectionChangeAction::Insert, size_t(1)));
+
+	list.RemoveAt(0);
+	EXPECT_EQ(changes.back(), std::make_pair(CollectionChangeAction::Remove, size_t(0)));
+	EXPECT_EQ(lastValue, "a"); // صпõƳֵ
+
+	EXPECT_TRUE(list.Remove("c"));
+	EXPECT_FALSE(list.Remove("z"));
+	EXPECT_EQ(changes.size(), 5);
+	EXPECT_EQ(list.Size(), 1);
+}
+
+TEST(BindableListTest, SetModifyAndMove)
+{
+	BindableList<int> list;
+	for (int i = 0; i < 4; ++i)
+		list.Add(i);
+
+	ListChange<int> last {};
+	int lastValue = -1;
+	auto u = list.Register([&](const ListChange<int>& c)
+		{
+			last = c;
+			lastValue = c.value ? *c.value : -1;
+		});
+
+	list.Set(2, 20);
+	EXPECT_EQ(last.action, CollectionChangeAction::Update);
+	EXPECT_EQ(last.index, 2);
+	EXPECT_EQ(lastValue, 20);
+
+	list.Modify(0, [](int& v) { v += 100; });
+	EXPECT_EQ(list[0], 100);
+	EXPECT_EQ(lastValue, 100);
+
+	list.Move(0, 3);
+	EXPECT_EQ(last.action, CollectionChangeAction::Move);
+	EXPECT_EQ(last.index, 0);
+	EXPECT_EQ(last.newIndex, 3);
+	EXPECT_EQ(list.GetValues(), (std::vector<int> { 1, 20, 3, 100 }));
+
+	list.Move(3, 1);
+	EXPECT_EQ(list.GetValues(), (std::vector<int> { 1, 100, 20, 3 }));
+
+	list.Clear();
+	EXPECT_EQ(last.action, CollectionChangeAction::Reset);
+	EXPECT_TRUE(list.Empty());
+}
+
+TEST(BindableListTest, OutOfRangeThrows)
+{
+	BindableList<int> list;
+	EXPECT_THROW(list.Insert(1, 0), std::out_of_range);
+	EXPECT_THROW(list.RemoveAt(0), std::out_of_range);
+	EXPECT_THROW(list.Set(0, 1), std::out_of_range);
+	EXPECT_THROW(list.Move(0, 0), std::out_of_range);
+}
+
+TEST(BindableListTest, UnRegisterStopsNotification)
+{
+	BindableList<int> list;
+	int count = 0;
+	auto u = list.Register([&](const ListChange<int>&) { ++count; });
+	list.Add(1);
+	u->UnRegister();
+	list.Add(2);
+	EXPECT_EQ(count, 1);
+	EXPECT_NO_THROW(u->UnRegister());
+}
+
+TEST(BindableListTest, UnRegisterAfterListDestroyed)
+{
+	std::shared_ptr<BindableCollectionUnRegister<ListChange<int>>> u;
+	{
+		BindableList<int> list;
+		u = list.Register([](const ListChange<int>&) {});
+	}
+	EXPECT_NO_THROW(u->UnRegister());
+}
+
+TEST(BindableMapTest, SetUpdateRemoveDeltas)
+{
+	BindableMap<std::string, int> map;
+	std::vector<CollectionChangeAction> actions;
+	std::string lastKey;
+	int lastValue = 0;
+	auto u = map.Register([&](const MapChange<std::string, int>& c)
+		{
+			actions.push_back(c.action);
+			if (c.key)
+				lastKey = *c.key;
+			if (c.value)
+				lastValue = *c.value;
+		});
+
+	map.Set("hp", 100);
+	EXPECT_EQ(actions.back(), CollectionChangeAction::Insert);
+	map.Set("hp", 80);
+	EXPECT_EQ(actions.back(), CollectionChangeAction::Update);
+	EXPECT_EQ(lastValue, 80);
+
+	map.Modify("hp", [](int& v) { v -= 30; });
+	EXPECT_EQ(map.Get("hp"), 50);
+	EXPECT_EQ(lastValue, 50);
+
+	EXPECT_TRUE(map.Remove("hp"));
+	EXPECT_EQ(actions.back(), CollectionChangeAction::Remove);
+	EXPECT_EQ(lastKey, "hp");
+	EXPECT_EQ(lastValue, 50);
+	EXPECT_FALSE(map.Remove("hp"));
+	EXPECT_EQ(map.Find("hp"), nullptr);
+
+	map.Set("mp", 1);
+	map.Clear();
+	EXPECT_EQ(actions.back(), CollectionChangeAction::Reset);
+	EXPECT_TRUE(map.Empty());
+	EXPECT_THROW(map.Modify("mp", [](int&) {}), std::out_of_range);
+}
+
 // ========== ӿڣICanGetModelȣԪ ==========
 
 class DummyArch : public Architecture
@@ -1212,6 +1656,3280 @@ TEST(ArchitectureTest, RegisterSameTypeDifferentInstance)
 	EXPECT_THROW(arch->RegisterModel<ArchTestModel>(model2), ComponentAlreadyRegisteredException);
 }
 
+class LifetimeCountingCommand : public AbstractCommand
+{
+public:
+	static inline int constructed = 0;
+	static inline int destroyed = 0;
+	static inline int executed = 0;
+	static inline int lastArg = 0;
+
+	explicit LifetimeCountingCommand(int arg) { ++constructed; lastArg = arg; }
+	~LifetimeCountingCommand() override { ++destroyed; }
+
+protected:
+	void OnExecute() override
+	{
+		EXPECT_NE(GetArchitecture().lock(), nullptr);
+		++executed;
+	}
+};
+
+TEST(ArchitectureTest, SendCommandTemplateConstructsInPlace)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	LifetimeCountingCommand::constructed = 0;
+	LifetimeCountingCommand::destroyed = 0;
+	LifetimeCountingCommand::executed = 0;
+	for (int i = 0; i < 3; ++i)
+		arch->SendCommand<LifetimeCountingCommand>(i);
+	EXPECT_EQ(LifetimeCountingCommand::constructed, 3);
+	EXPECT_EQ(LifetimeCountingCommand::executed, 3);
+	// ÿ SendCommand ǰ
+	EXPECT_EQ(LifetimeCountingCommand::destroyed, 3);
+	EXPECT_EQ(LifetimeCountingCommand::lastArg, 2);
+}
+
+class InterceptingArchitecture : public Architecture
+{
+public:
+	int intercepted = 0;
+	void ExecuteCommand(IJCommand& command) override
+	{
+		++intercepted;
+		Architecture::ExecuteCommand(command);
+	}
+
+protected:
+	void Init() override {}
+};
+
+TEST(ArchitectureTest, ExecuteCommandSeesAllSendPaths)
+{
+	auto arch = std::make_shared<InterceptingArchitecture>();
+	arch->SendCommand<LifetimeCountingCommand>(1);
+	arch->SendCommand(std::make_unique<LifetimeCountingCommand>(2));
+	EXPECT_EQ(arch->intercepted, 2);
+}
+
+// ========== 첽 ==========
+class AsyncRecordModel : public AbstractModel
+{
+public:
+	std::mutex mutex;
+	std::vector<int> order;
+	std::atomic<int> running { 0 };
+	std::atomic<int> maxRunning { 0 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class AsyncOrderedCommand : public AbstractCommand
+{
+public:
+	explicit AsyncOrderedCommand(int id) : mId(id) {}
+	std::type_index GetOrderingKey() const override { return typeid(AsyncRecordModel); }
+
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<AsyncRecordModel>();
+		int now = ++model->running;
+		int prev = model->maxRunning.load();
+		while (now > prev && !model->maxRunning.compare_exchange_weak(prev, now)) {}
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		{
+			std::lock_guard<std::mutex> lock(model->mutex);
+			model->order.push_back(mId);
+		}
+		--model->running;
+	}
+
+private:
+	int mId;
+};
+
+class AsyncThrowingCommand : public AbstractCommand
+{
+protected:
+	void OnExecute() override { throw std::runtime_error("async failure"); }
+};
+
+class AsyncRendezvousCommand : public AbstractCommand
+{
+public:
+	AsyncRendezvousCommand(std::atomic<int>* arrived, std::atomic<bool>* metPeer)
+		: mArrived(arrived), mMetPeer(metPeer) {}
+
+protected:
+	void OnExecute() override
+	{
+		++*mArrived;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+		while (mArrived->load() < 2 && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::yield();
+		if (mArrived->load() >= 2)
+			*mMetPeer = true;
+	}
+
+private:
+	std::atomic<int>* mArrived;
+	std::atomic<bool>* mMetPeer;
+};
+
+class AsyncArchitecture : public Architecture
+{
+protected:
+	void Init() override { RegisterModel(std::make_shared<AsyncRecordModel>()); }
+};
+
+TEST(AsyncCommandTest, SendCommandAsyncRunsOnWorkerThread)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	std::thread::id executedOn;
+	class ThreadIdCommand : public AbstractCommand
+	{
+	public:
+		explicit ThreadIdCommand(std::thread::id* out) : mOut(out) {}
+
+	protected:
+		void OnExecute() override { *mOut = std::this_thread::get_id(); }
+
+	private:
+		std::thread::id* mOut;
+	};
+	auto future = arch->SendCommandAsync<ThreadIdCommand>(&executedOn);
+	future.get();
+	EXPECT_NE(executedOn, std::thread::id());
+	EXPECT_NE(executedOn, std::this_thread::get_id());
+}
+
+TEST(AsyncCommandTest, ExceptionPropagatesThroughFuture)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	auto future = arch->SendCommandAsync<AsyncThrowingCommand>();
+	EXPECT_THROW(future.get(), std::runtime_error);
+	EXPECT_THROW(arch->SendCommandAsync(nullptr), std::invalid_argument);
+}
+
+TEST(AsyncCommandTest, SameOrderingKeyIsSerialized)
+{
+	auto arch = std::make_shared<AsyncArchitecture>();
+	arch->SetAsyncThreadCount(4);
+	arch->InitArchitecture();
+
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < 20; ++i)
+		futures.push_back(arch->SendCommandAsync<AsyncOrderedCommand>(i));
+	for (auto& f : futures)
+		f.get();
+
+	auto model = arch->GetModel<AsyncRecordModel>();
+	std::vector<int> expected(20);
+	for (int i = 0; i < 20; ++i)
+		expected[i] = i;
+	EXPECT_EQ(model->order, expected);
+	EXPECT_EQ(model->maxRunning.load(), 1);
+}
+
+TEST(AsyncCommandTest, UnorderedCommandsRunInParallel)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	arch->SetAsyncThreadCount(2);
+	std::atomic<int> arrived { 0 };
+	std::atomic<bool> met1 { false }, met2 { false };
+	auto f1 = arch->SendCommandAsync<AsyncRendezvousCommand>(&arrived, &met1);
+	auto f2 = arch->SendCommandAsync<AsyncRendezvousCommand>(&arrived, &met2);
+	f1.get();
+	f2.get();
+	EXPECT_TRUE(met1);
+	EXPECT_TRUE(met2);
+}
+
+TEST(AsyncCommandTest, ICanSendCommandAsync)
+{
+	auto arch = std::make_shared<AsyncArchitecture>();
+	arch->InitArchitecture();
+	CanSendCommandObj obj;
+	obj.mArch = arch;
+	obj.SendCommandAsync<AsyncOrderedCommand>(7).get();
+	EXPECT_EQ(arch->GetModel<AsyncRecordModel>()->order, std::vector<int> { 7 });
+}
+
+// ========== ӳȲ ==========
+class RecordingCommand : public AbstractCommand
+{
+public:
+	RecordingCommand(std::vector<int>* log, int id, std::chrono::milliseconds cost = {})
+		: mLog(log), mId(id), mCost(cost) {}
+
+protected:
+	void OnExecute() override
+	{
+		if (mCost.count() > 0)
+			std::this_thread::sleep_for(mCost);
+		mLog->push_back(mId);
+	}
+
+private:
+	std::vector<int>* mLog;
+	int mId;
+	std::chrono::milliseconds mCost;
+};
+
+TEST(CommandSchedulerTest, EnqueuedCommandsRunOnTickByPriority)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	std::vector<int> log;
+	arch->EnqueueCommand(std::make_unique<RecordingCommand>(&log, 3), CommandPriority::Low);
+	arch->EnqueueCommand<RecordingCommand>(&log, 2);
+	arch->EnqueueCommand(std::make_unique<RecordingCommand>(&log, 1), CommandPriority::High);
+	EXPECT_TRUE(log.empty());
+	EXPECT_EQ(arch->GetCommandSchedulerStats().queueDepth, 3);
+
+	arch->SetCommandBudget(std::chrono::seconds(1));
+	arch->Tick();
+	EXPECT_EQ(log, (std::vector<int> { 1, 2, 3 }));
+	auto stats = arch->GetCommandSchedulerStats();
+	EXPECT_EQ(stats.queueDepth, 0);
+	EXPECT_EQ(stats.executedLastTick, 3);
+}
+
+TEST(CommandSchedulerTest, BudgetCarriesRemainingCommandsOver)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	std::vector<int> log;
+	for (int i = 0; i < 5; ++i)
+		arch->EnqueueCommand<RecordingCommand>(&log, i, std::chrono::milliseconds(2));
+
+	arch->SetCommandBudget(std::chrono::milliseconds(3));
+	arch->Tick();
+	auto stats = arch->GetCommandSchedulerStats();
+	EXPECT_GE(stats.executedLastTick, 1);
+	EXPECT_LE(stats.executedLastTick, 2);
+	EXPECT_EQ(stats.queueDepth, 5 - stats.executedLastTick);
+	EXPECT_GE(stats.lastTickTime, std::chrono::milliseconds(2));
+
+	while (arch->GetCommandSchedulerStats().queueDepth > 0)
+		arch->Tick();
+	EXPECT_EQ(log, (std::vector<int> { 0, 1, 2, 3, 4 }));
+}
+
+TEST(CommandSchedulerTest, FailingCommandDoesNotStopTick)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	std::vector<int> log;
+	arch->EnqueueCommand<AsyncThrowingCommand>();
+	arch->EnqueueCommand<RecordingCommand>(&log, 1);
+	arch->Tick();
+	EXPECT_EQ(log, std::vector<int> { 1 });
+	EXPECT_THROW(arch->EnqueueCommand(nullptr), std::invalid_argument);
+}
+
+// ========== ѯ ==========
+class ScoreModel : public AbstractModel
+{
+public:
+	std::vector<int> scores { 1, 2, 3 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class SumAboveQuery : public AbstractQuery<int>
+{
+public:
+	static inline int evaluations = 0;
+	explicit SumAboveQuery(int threshold) : mThreshold(threshold) {}
+
+protected:
+	int OnDo() override
+	{
+		++evaluations;
+		int sum = 0;
+		for (int v : GetModel<ScoreModel>()->scores)
+			if (v > mThreshold)
+				sum += v;
+		return sum;
+	}
+
+private:
+	int mThreshold;
+};
+
+class AddScoreCommand : public AbstractCommand
+{
+public:
+	explicit AddScoreCommand(int v) : mValue(v) {}
+
+protected:
+	void OnExecute() override { GetModel<ScoreModel>()->scores.push_back(mValue); }
+
+private:
+	int mValue;
+};
+
+class ScoreArchitecture : public Architecture
+{
+protected:
+	void Init() override { RegisterModel(std::make_shared<ScoreModel>()); }
+};
+
+TEST(QueryCacheTest, RepeatedQueryHitsCache)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	SumAboveQuery::evaluations = 0;
+
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(1), 5);
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(1), 5);
+	EXPECT_EQ(SumAboveQuery::evaluations, 1);
+
+	// ͬ
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(0), 6);
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(0), 6);
+	EXPECT_EQ(SumAboveQuery::evaluations, 2);
+}
+
+TEST(QueryCacheTest, CommandInvalidatesDependentEntries)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	SumAboveQuery::evaluations = 0;
+
+	auto model = arch->GetModel<ScoreModel>();
+	uint64_t version = model->GetVersion();
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(1), 5);
+	arch->SendCommand<AddScoreCommand>(10);
+	EXPECT_GT(model->GetVersion(), version);
+
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(1), 15);
+	EXPECT_EQ(SumAboveQuery::evaluations, 2);
+}
+
+TEST(QueryCacheTest, ManualVersionIncrementInvalidates)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	SumAboveQuery::evaluations = 0;
+
+	auto model = arch->GetModel<ScoreModel>();
+	arch->SendCachedQuery<SumAboveQuery>(1);
+	model->scores.push_back(4);
+	model->IncrementVersion();
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(1), 9);
+	EXPECT_EQ(SumAboveQuery::evaluations, 2);
+
+	arch->ClearQueryCache();
+	arch->SendCachedQuery<SumAboveQuery>(1);
+	EXPECT_EQ(SumAboveQuery::evaluations, 3);
+}
+
+TEST(QueryCacheTest, SendQueryDoesNotBumpVersion)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<ScoreModel>();
+	uint64_t version = model->GetVersion();
+	arch->SendQuery<SumAboveQuery>(1);
+	arch->SendCachedQuery<SumAboveQuery>(2);
+	EXPECT_EQ(model->GetVersion(), version);
+}
+
+TEST(QueryCacheTest, ICanSendCachedQuery)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	SumAboveQuery::evaluations = 0;
+	CanSendQueryObj obj;
+	obj.mArch = arch;
+	EXPECT_EQ(obj.SendCachedQuery<SumAboveQuery>(2), 3);
+	EXPECT_EQ(arch->SendCachedQuery<SumAboveQuery>(2), 3);
+	EXPECT_EQ(SumAboveQuery::evaluations, 1);
+}
+
+class RatingModel : public AbstractModel
+{
+public:
+	RatingModel() { OwnProperty(rating); }
+	BindableProperty<int> rating { 3 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class RatedArchitecture : public Architecture
+{
+protected:
+	void Init() override
+	{
+		RegisterModel(std::make_shared<ScoreModel>());
+		RegisterModel(std::make_shared<RatingModel>());
+	}
+};
+
+class RatingQuery : public AbstractQuery<int>
+{
+public:
+	static inline int evaluations = 0;
+
+protected:
+	int OnDo() override
+	{
+		++evaluations;
+		return GetModel<RatingModel>()->rating.GetValue();
+	}
+};
+
+// ֻȡ ScoreModelд RatingModelʵֻȡ
+class DeclaredReadScoreCommand : public AbstractCommand
+{
+public:
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Read<ScoreModel>().Write<RatingModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override { static_cast<void>(GetModel<ScoreModel>()->scores.size()); }
+};
+
+// δдϣȡ Model
+class AlternatingAccessCommand : public AbstractCommand
+{
+protected:
+	void OnExecute() override
+	{
+		for (int i = 0; i < 3; ++i)
+		{
+			GetModel<ScoreModel>();
+			GetModel<RatingModel>();
+		}
+	}
+};
+
+TEST(QueryCacheTest, DeclaredCommandBumpsOnlyWrittenModels)
+{
+	auto arch = std::make_shared<RatedArchitecture>();
+	arch->InitArchitecture();
+	SumAboveQuery::evaluations = 0;
+	auto score = arch->GetModel<ScoreModel>();
+	auto rating = arch->GetModel<RatingModel>();
+	uint64_t scoreVersion = score->GetVersion();
+	uint64_t ratingVersion = rating->GetVersion();
+
+	arch->SendCachedQuery<SumAboveQuery>(1);
+	arch->SendCommand<DeclaredReadScoreCommand>();
+	EXPECT_EQ(score->GetVersion(), scoreVersion);
+	EXPECT_EQ(rating->GetVersion(), ratingVersion + 1);
+	arch->SendCachedQuery<SumAboveQuery>(1);
+	EXPECT_EQ(SumAboveQuery::evaluations, 1);
+}
+
+TEST(QueryCacheTest, OwnedPropertyWriteOutsideCommandInvalidates)
+{
+	auto arch = std::make_shared<RatedArchitecture>();
+	arch->InitArchitecture();
+	RatingQuery::evaluations = 0;
+	auto rating = arch->GetModel<RatingModel>();
+	uint64_t version = rating->GetVersion();
+
+	EXPECT_EQ(arch->SendCachedQuery<RatingQuery>(), 3);
+	rating->rating = 5;
+	EXPECT_EQ(rating->GetVersion(), version + 1);
+	EXPECT_EQ(arch->SendCachedQuery<RatingQuery>(), 5);
+	EXPECT_EQ(RatingQuery::evaluations, 2);
+}
+
+TEST(QueryCacheTest, FailedModifyOnOwnedPropertyInvalidates)
+{
+	auto arch = std::make_shared<RatedArchitecture>();
+	arch->InitArchitecture();
+	RatingQuery::evaluations = 0;
+	auto rating = arch->GetModel<RatingModel>();
+
+	EXPECT_EQ(arch->SendCachedQuery<RatingQuery>(), 3);
+	rating->rating.Modify([](int& v)
+		{
+			v = 4;
+			return false;
+		});
+	EXPECT_EQ(arch->SendCachedQuery<RatingQuery>(), 4);
+	EXPECT_THROW(rating->rating.Modify([](int& v)
+		{
+			v = 5;
+			throw std::runtime_error("failed");
+		}), std::runtime_error);
+	EXPECT_EQ(arch->SendCachedQuery<RatingQuery>(), 5);
+	EXPECT_EQ(RatingQuery::evaluations, 3);
+}
+
+class InventoryModel : public AbstractModel
+{
+public:
+	InventoryModel() { OwnProperty(items, stock); }
+	BindableList<int> items;
+	BindableMap<std::string, int> stock;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class InventoryArchitecture : public Architecture
+{
+protected:
+	void Init() override
+	{
+		RegisterModel(std::make_shared<ScoreModel>());
+		RegisterModel(std::make_shared<InventoryModel>());
+	}
+};
+
+class InventoryTotalQuery : public AbstractQuery<int>
+{
+public:
+	static inline int evaluations = 0;
+
+protected:
+	int OnDo() override
+	{
+		++evaluations;
+		auto model = GetModel<InventoryModel>();
+		int total = 0;
+		for (int item : model->items)
+			total += item;
+		for (auto& [name, count] : model->stock.GetValues())
+			total += count;
+		return total;
+	}
+};
+
+// д ScoreModelʵ޸ InventoryModel ļ
+class MisdeclaredRestockCommand : public AbstractCommand
+{
+public:
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Write<ScoreModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override { GetModel<InventoryModel>()->stock.Set("iron", 1); }
+};
+
+TEST(QueryCacheTest, OwnedCollectionEditsInvalidate)
+{
+	auto arch = std::make_shared<InventoryArchitecture>();
+	arch->InitArchitecture();
+	InventoryTotalQuery::evaluations = 0;
+	auto model = arch->GetModel<InventoryModel>();
+	uint64_t version = model->GetVersion();
+
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 0);
+	model->items.Add(2);
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 2);
+	model->items.Set(0, 5);
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 5);
+	model->stock.Set("wood", 3);
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 8);
+	model->stock.Modify("wood", [](int& count) { count *= 2; });
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 11);
+	model->stock.Remove("wood");
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 5);
+	model->items.Clear();
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 0);
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 0);
+	EXPECT_EQ(InventoryTotalQuery::evaluations, 7);
+	EXPECT_EQ(model->GetVersion(), version + 6);
+
+	// д뼯ϲ Model޸ʹʧЧ
+	arch->SendCommand<MisdeclaredRestockCommand>();
+	EXPECT_EQ(arch->SendCachedQuery<InventoryTotalQuery>(), 1);
+	EXPECT_EQ(InventoryTotalQuery::evaluations, 8);
+}
+
+TEST(QueryCacheTest, UndeclaredCommandBumpsEachAccessedModelOnce)
+{
+	auto arch = std::make_shared<RatedArchitecture>();
+	arch->InitArchitecture();
+	auto score = arch->GetModel<ScoreModel>();
+	auto rating = arch->GetModel<RatingModel>();
+	uint64_t scoreVersion = score->GetVersion();
+	uint64_t ratingVersion = rating->GetVersion();
+
+	arch->SendCommand<AlternatingAccessCommand>();
+	EXPECT_EQ(score->GetVersion(), scoreVersion + 1);
+	EXPECT_EQ(rating->GetVersion(), ratingVersion + 1);
+}
+
+// ========== вѯ ==========
+class ThreadRecordingQuery : public AbstractQuery<std::thread::id>
+{
+public:
+	ThreadRecordingQuery(bool readOnly, std::atomic<int>* arrived = nullptr)
+		: mReadOnly(readOnly), mArrived(arrived) {}
+	bool IsReadOnly() const override { return mReadOnly; }
+
+protected:
+	std::thread::id OnDo() override
+	{
+		if (mArrived)
+		{
+			// ֻѯҪ˴˲вȫ
+			++*mArrived;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+			while (mArrived->load() < 2 && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::yield();
+		}
+		return std::this_thread::get_id();
+	}
+
+private:
+	bool mReadOnly;
+	std::atomic<int>* mArrived;
+};
+
+class ReadOnlySumQuery : public AbstractQuery<int>
+{
+public:
+	explicit ReadOnlySumQuery(int threshold) : mThreshold(threshold) {}
+	bool IsReadOnly() const override { return true; }
+
+protected:
+	int OnDo() override
+	{
+		int sum = 0;
+		for (int v : GetModel<ScoreModel>()->scores)
+			if (v > mThreshold)
+				sum += v;
+		return sum;
+	}
+
+private:
+	int mThreshold;
+};
+
+class FailingReadOnlyQuery : public AbstractQuery<int>
+{
+public:
+	bool IsReadOnly() const override { return true; }
+
+protected:
+	int OnDo() override { throw std::runtime_error("query failed"); }
+};
+
+TEST(SendQueriesTest, ReturnsResultsInOrder)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	auto [a, b, c] = arch->SendQueries(
+		std::make_unique<ReadOnlySumQuery>(0),
+		std::make_unique<ReadOnlySumQuery>(2),
+		std::make_unique<MyQuery<std::string>>("text"));
+	EXPECT_EQ(a, 6);
+	EXPECT_EQ(b, 3);
+	EXPECT_EQ(c, "text");
+}
+
+TEST(SendQueriesTest, ReadOnlyQueriesRunConcurrently)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	arch->SetAsyncThreadCount(2);
+	std::atomic<int> arrived { 0 };
+	auto [t1, t2, t3] = arch->SendQueries(
+		std::make_unique<ThreadRecordingQuery>(true, &arrived),
+		std::make_unique<ThreadRecordingQuery>(true, &arrived),
+		std::make_unique<ThreadRecordingQuery>(false));
+	EXPECT_EQ(arrived.load(), 2);
+	EXPECT_NE(t1, t2);
+	// ֻѯڵִ߳
+	EXPECT_EQ(t3, std::this_thread::get_id());
+}
+
+TEST(SendQueriesTest, ExceptionIsRethrown)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	EXPECT_THROW(arch->SendQueries(std::make_unique<ReadOnlySumQuery>(0), std::make_unique<FailingReadOnlyQuery>()),
+		std::runtime_error);
+	EXPECT_THROW(arch->SendQueries(std::unique_ptr<ReadOnlySumQuery>()), std::invalid_argument);
+}
+
+TEST(SendQueriesTest, NestedFanOutOnSingleThreadPool)
+{
+	// ̳߳ٴβвѯȴЭִУ
+	class NestedQuery : public AbstractQuery<int>
+	{
+	public:
+		bool IsReadOnly() const override { return true; }
+
+	protected:
+		int OnDo() override
+		{
+			auto [a, b] = SendQueries(std::make_unique<ReadOnlySumQuery>(0), std::make_unique<ReadOnlySumQuery>(1));
+			return a + b;
+		}
+	};
+
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->SetAsyncThreadCount(1);
+	arch->InitArchitecture();
+	auto [x, y] = arch->SendQueries(std::make_unique<NestedQuery>(), std::make_unique<NestedQuery>());
+	EXPECT_EQ(x, 11);
+	EXPECT_EQ(y, 11);
+}
+
+// ========== / ==========
+class DocumentModel : public AbstractModel
+{
+public:
+	DocumentModel() { OwnProperty(title, width); }
+	BindableProperty<std::string> title { std::string("untitled") };
+	BindableProperty<int> width { 100 };
+	std::vector<int> rows = std::vector<int>(100000, 0);
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class RenameCommand : public AbstractUndoableCommand
+{
+public:
+	explicit RenameCommand(std::string title) : mTitle(std::move(title)) {}
+
+protected:
+	void OnExecute() override { GetModel<DocumentModel>()->title = mTitle; }
+
+private:
+	std::string mTitle;
+};
+
+class ResizeCommand : public AbstractUndoableCommand
+{
+public:
+	explicit ResizeCommand(int width) : mWidth(width) {}
+
+protected:
+	void OnExecute() override { GetModel<DocumentModel>()->width = mWidth; }
+
+private:
+	int mWidth;
+};
+
+class RenameAndResizeCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		SendCommand<RenameCommand>("both");
+		SendCommand<ResizeCommand>(300);
+	}
+};
+
+class FailingResizeCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		GetModel<DocumentModel>()->width = 999;
+		throw std::runtime_error("resize failed");
+	}
+};
+
+// Modify Ķֵȴ false
+class SilentResizeCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		GetModel<DocumentModel>()->width.Modify([](int& width)
+			{
+				width = 250;
+				return false;
+			});
+	}
+};
+
+class AppendRowCommand : public AbstractUndoableCommand
+{
+public:
+	explicit AppendRowCommand(int value) : mValue(value) {}
+
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<DocumentModel>();
+		model->rows.push_back(mValue);
+		int value = mValue;
+		RecordChange([model] { model->rows.pop_back(); }, [model, value] { model->rows.push_back(value); }, sizeof(int));
+	}
+
+private:
+	int mValue;
+};
+
+// ͬʱ޸ Model 벻κ Model Ľ״̬
+class ResizeWithSelectionCommand : public AbstractUndoableCommand
+{
+public:
+	ResizeWithSelectionCommand(int width, BindableProperty<int>* selection) : mWidth(width), mSelection(selection) {}
+
+protected:
+	void OnExecute() override
+	{
+		GetModel<DocumentModel>()->width = mWidth;
+		*mSelection = mWidth;
+	}
+
+private:
+	int mWidth;
+	BindableProperty<int>* mSelection;
+};
+
+//  GetModel ֱ޸д Model
+class DeclaredRenameCommand : public AbstractUndoableCommand
+{
+public:
+	DeclaredRenameCommand(DocumentModel* model, std::string title) : mModel(model), mTitle(std::move(title)) {}
+
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Write<DocumentModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override { mModel->title = mTitle; }
+
+private:
+	DocumentModel* mModel;
+	std::string mTitle;
+};
+
+class WidthQuery : public AbstractQuery<int>
+{
+protected:
+	int OnDo() override { return GetModel<DocumentModel>()->width; }
+};
+
+class DocumentArchitecture : public Architecture
+{
+protected:
+	void Init() override { RegisterModel(std::make_shared<DocumentModel>()); }
+};
+
+class RestockCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<InventoryModel>();
+		model->items.Add(7);
+		model->items.Insert(0, 1);
+		model->items.Move(0, 1);
+		model->items.Modify(0, [](int& item) { item += 10; });
+		model->stock.Set("wood", 4);
+		model->stock.Set("stone", 9);
+		model->stock.Remove("stone");
+	}
+};
+
+class ClearInventoryCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<InventoryModel>();
+		model->items.RemoveAt(0);
+		model->items.Clear();
+		model->stock.Clear();
+	}
+};
+
+TEST(UndoRedoTest, OwnedCollectionEditsAreRecorded)
+{
+	auto arch = std::make_shared<InventoryArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<InventoryModel>();
+	model->items.Add(3);
+	model->stock.Set("stone", 2);
+	auto items = model->items.GetValues();
+	auto stock = model->stock.GetValues();
+
+	arch->SendCommand<RestockCommand>();
+	auto restockedItems = model->items.GetValues();
+	auto restockedStock = model->stock.GetValues();
+	EXPECT_EQ(restockedItems, (std::vector<int> { 13, 1, 7 }));
+
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->items.GetValues(), items);
+	EXPECT_EQ(model->stock.GetValues(), stock);
+	EXPECT_TRUE(arch->Redo());
+	EXPECT_EQ(model->items.GetValues(), restockedItems);
+	EXPECT_EQ(model->stock.GetValues(), restockedStock);
+
+	arch->SendCommand<ClearInventoryCommand>();
+	EXPECT_TRUE(model->items.Empty());
+	EXPECT_TRUE(model->stock.Empty());
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->items.GetValues(), restockedItems);
+	EXPECT_EQ(model->stock.GetValues(), restockedStock);
+}
+
+TEST(UndoRedoTest, UndoAndRedoRestorePropertyValues)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<DocumentModel>();
+	std::vector<std::string> titles;
+	auto unRegister = model->title.Register([&](const std::string& v) { titles.push_back(v); });
+
+	arch->SendCommand<RenameCommand>("first");
+	arch->SendCommand<RenameCommand>("second");
+	EXPECT_EQ(arch->GetCommandHistory().GetUndoCount(), 2u);
+
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->title.GetValue(), "first");
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->title.GetValue(), "untitled");
+	EXPECT_FALSE(arch->Undo());
+
+	EXPECT_TRUE(arch->Redo());
+	EXPECT_EQ(model->title.GetValue(), "first");
+	// /֪ͬͨ۲
+	EXPECT_EQ(titles, (std::vector<std::string> { "first", "second", "first", "untitled", "first" }));
+
+	// ʹջʧЧ
+	arch->SendCommand<ResizeCommand>(200);
+	EXPECT_FALSE(arch->GetCommandHistory().CanRedo());
+	EXPECT_FALSE(arch->Redo());
+}
+
+TEST(UndoRedoTest, NestedCommandsFormOneEntry)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<DocumentModel>();
+
+	arch->SendCommand<RenameAndResizeCommand>();
+	EXPECT_EQ(arch->GetCommandHistory().GetUndoCount(), 1u);
+	arch->Undo();
+	EXPECT_EQ(model->title.GetValue(), "untitled");
+	EXPECT_EQ(model->width.GetValue(), 100);
+}
+
+TEST(UndoRedoTest, FailedCommandIsRolledBack)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	EXPECT_THROW(arch->SendCommand<FailingResizeCommand>(), std::runtime_error);
+	EXPECT_EQ(arch->GetModel<DocumentModel>()->width.GetValue(), 100);
+	EXPECT_EQ(arch->GetCommandHistory().GetUndoCount(), 0u);
+}
+
+TEST(UndoRedoTest, ModifyReturningFalseAfterWritingIsRecorded)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<DocumentModel>();
+	arch->SendCommand<SilentResizeCommand>();
+	EXPECT_EQ(model->width.GetValue(), 250);
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->width.GetValue(), 100);
+	EXPECT_TRUE(arch->Redo());
+	EXPECT_EQ(model->width.GetValue(), 250);
+}
+
+TEST(UndoRedoTest, RecordChangeCoversCustomState)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<DocumentModel>();
+
+	arch->SendCommand<AppendRowCommand>(42);
+	EXPECT_EQ(model->rows.size(), 100001u);
+	arch->Undo();
+	EXPECT_EQ(model->rows.size(), 100000u);
+	arch->Redo();
+	EXPECT_EQ(model->rows.back(), 42);
+}
+
+TEST(UndoRedoTest, HistoryStoresDeltasNotModels)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	arch->SendCommand<ResizeCommand>(1);
+	arch->SendCommand<AppendRowCommand>(1);
+	// Model  100000 ݣʷֻ¼СĶ
+	EXPECT_LT(arch->GetCommandHistory().GetMemoryUsage(), 1024u);
+}
+
+TEST(UndoRedoTest, MemoryLimitDropsOldestEntries)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto& history = arch->GetCommandHistory();
+	for (int i = 1; i <= 10; ++i)
+		arch->SendCommand<ResizeCommand>(i);
+	size_t perEntry = history.GetMemoryUsage() / 10;
+	history.SetMemoryLimit(perEntry * 3);
+	EXPECT_EQ(history.GetUndoCount(), 3u);
+	EXPECT_LE(history.GetMemoryUsage(), perEntry * 3);
+
+	while (arch->Undo()) {}
+	// ļ¼Ѷֻܳ 7 ֮ǰ
+	EXPECT_EQ(arch->GetModel<DocumentModel>()->width.GetValue(), 7);
+}
+
+TEST(UndoRedoTest, OnlyPropertiesOfCommandModelsAreRecorded)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	BindableProperty<int> selection { 0 };
+
+	arch->SendCommand<ResizeWithSelectionCommand>(150, &selection);
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(arch->GetModel<DocumentModel>()->width.GetValue(), 100);
+	// ״̬ʵ Model볷ʷ
+	EXPECT_EQ(selection.GetValue(), 150);
+}
+
+TEST(UndoRedoTest, DeclaredWritesAreRecorded)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<DocumentModel>();
+
+	arch->SendCommand<DeclaredRenameCommand>(model.get(), "declared");
+	EXPECT_EQ(arch->GetCommandHistory().GetUndoCount(), 1u);
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(model->title.GetValue(), "untitled");
+}
+
+TEST(UndoRedoTest, UndoInvalidatesCachedQueries)
+{
+	auto arch = std::make_shared<DocumentArchitecture>();
+	arch->InitArchitecture();
+	arch->SendCommand<ResizeCommand>(250);
+	EXPECT_EQ(arch->SendCachedQuery<WidthQuery>(), 250);
+	arch->Undo();
+	EXPECT_EQ(arch->SendCachedQuery<WidthQuery>(), 100);
+	arch->Redo();
+	EXPECT_EQ(arch->SendCachedQuery<WidthQuery>(), 250);
+}
+
+// ========== ־ ==========
+class JournaledAddScoreCommand : public AbstractCommand, public ISerializableCommand
+{
+public:
+	explicit JournaledAddScoreCommand(int v) : mValue(v) {}
+	std::string_view GetJournalName() const override { return "AddScore"; }
+	void Serialize(std::string& out) const override { out += std::to_string(mValue); }
+
+	static std::unique_ptr<JournaledAddScoreCommand> Deserialize(std::string_view payload)
+	{
+		return std::make_unique<JournaledAddScoreCommand>(std::stoi(std::string(payload)));
+	}
+
+protected:
+	void OnExecute() override { GetModel<ScoreModel>()->scores.push_back(mValue); }
+
+private:
+	int mValue;
+};
+
+// ڲ͵ڱ¼
+class JournaledPairCommand : public AbstractCommand, public ISerializableCommand
+{
+public:
+	explicit JournaledPairCommand(int v) : mValue(v) {}
+	std::string_view GetJournalName() const override { return "Pair"; }
+	void Serialize(std::string& out) const override { out += std::to_string(mValue); }
+
+	static std::unique_ptr<JournaledPairCommand> Deserialize(std::string_view payload)
+	{
+		return std::make_unique<JournaledPairCommand>(std::stoi(std::string(payload)));
+	}
+
+protected:
+	void OnExecute() override
+	{
+		SendCommand<JournaledAddScoreCommand>(mValue);
+		SendCommand<JournaledAddScoreCommand>(mValue + 1);
+	}
+
+private:
+	int mValue;
+};
+
+class JournalCounterModel : public AbstractModel
+{
+public:
+	std::atomic<int> total { 0 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class JournaledCountCommand : public AbstractCommand, public ISerializableCommand
+{
+public:
+	std::string_view GetJournalName() const override { return "Count"; }
+	void Serialize(std::string&) const override {}
+	static std::unique_ptr<JournaledCountCommand> Deserialize(std::string_view) { return std::make_unique<JournaledCountCommand>(); }
+
+protected:
+	void OnExecute() override { ++GetModel<JournalCounterModel>()->total; }
+};
+
+// ִ˳¼ֵʱ˶־˳д⣬־˳ִ˳
+class JournalOrderModel : public AbstractModel
+{
+public:
+	JournalOrderModel() { EnableAccessGuard(); }
+	std::mutex mutex;
+	std::vector<int> values;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class JournaledOrderCommand : public AbstractCommand, public ISerializableCommand
+{
+public:
+	explicit JournaledOrderCommand(int v) : mValue(v) {}
+	std::string_view GetJournalName() const override { return "Order"; }
+	void Serialize(std::string& out) const override { out += std::to_string(mValue); }
+
+	static std::unique_ptr<JournaledOrderCommand> Deserialize(std::string_view payload)
+	{
+		return std::make_unique<JournaledOrderCommand>(std::stoi(std::string(payload)));
+	}
+
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Write<JournalOrderModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<JournalOrderModel>();
+		{
+			std::lock_guard<std::mutex> lock(model->mutex);
+			model->values.push_back(mValue);
+		}
+		// ִ׷֮ļ
+		std::this_thread::yield();
+	}
+
+private:
+	int mValue;
+};
+
+class JournalArchitecture : public Architecture
+{
+protected:
+	void Init() override
+	{
+		RegisterModel(std::make_shared<ScoreModel>());
+		RegisterModel(std::make_shared<JournalCounterModel>());
+		RegisterModel(std::make_shared<JournalOrderModel>());
+		RegisterJournaledCommand<JournaledOrderCommand>("Order");
+		RegisterJournaledCommand<JournaledAddScoreCommand>("AddScore");
+		RegisterJournaledCommand<JournaledPairCommand>("Pair");
+		RegisterJournaledCommand<JournaledCountCommand>("Count");
+	}
+};
+
+static std::string JournalTestPath(const char* name)
+{
+	auto path = std::filesystem::temp_directory_path() / (std::string("jframework_") + name + ".journal");
+	std::filesystem::remove(path);
+	return path.string();
+}
+
+TEST(CommandJournalTest, ReplayRestoresState)
+{
+	auto path = JournalTestPath("replay");
+	{
+		auto arch = std::make_shared<JournalArchitecture>();
+		arch->InitArchitecture();
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+		arch->SendCommand<JournaledAddScoreCommand>(4);
+		arch->SendCommand<JournaledPairCommand>(10);
+		arch->SendCommand<AddScoreCommand>(99); // л¼
+		arch->DisableCommandJournal();
+	}
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	auto result = ReplayCommandJournal(*restored, path);
+	EXPECT_EQ(result.replayed, 2u);
+	EXPECT_FALSE(result.truncated);
+	EXPECT_TRUE(result.snapshotTag.empty());
+	EXPECT_EQ(restored->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 4, 10, 11 }));
+}
+
+TEST(CommandJournalTest, ReplayStartsAfterLastSnapshot)
+{
+	auto path = JournalTestPath("snapshot");
+	{
+		auto arch = std::make_shared<JournalArchitecture>();
+		arch->InitArchitecture();
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+		arch->SendCommand<JournaledAddScoreCommand>(4);
+		arch->GetCommandJournal()->MarkSnapshot("snap-1");
+		arch->SendCommand<JournaledAddScoreCommand>(5);
+		arch->GetCommandJournal()->MarkSnapshot("snap-2");
+		arch->SendCommand<JournaledAddScoreCommand>(6);
+	}
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	auto result = ReplayCommandJournal(*restored, path);
+	EXPECT_EQ(result.replayed, 1u);
+	EXPECT_EQ(result.snapshotTag, "snap-2");
+	EXPECT_EQ(restored->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 6 }));
+}
+
+TEST(CommandJournalTest, TornTailIsIgnoredAndTruncated)
+{
+	auto path = JournalTestPath("torn");
+	{
+		auto arch = std::make_shared<JournalArchitecture>();
+		arch->InitArchitecture();
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+		arch->SendCommand<JournaledAddScoreCommand>(4);
+	}
+	{
+		// ģд;ֻд˰¼
+		std::ofstream out(path, std::ios::binary | std::ios::app);
+		out.write("\x20\x00\x00\x00\x01", 5);
+	}
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	auto result = ReplayCommandJournal(*restored, path);
+	EXPECT_TRUE(result.truncated);
+	EXPECT_EQ(result.replayed, 1u);
+
+	// ´־ʱضϲȱ¼¼¼ط
+	restored->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+	restored->SendCommand<JournaledAddScoreCommand>(7);
+	restored->DisableCommandJournal();
+
+	auto again = std::make_shared<JournalArchitecture>();
+	again->InitArchitecture();
+	result = ReplayCommandJournal(*again, path);
+	EXPECT_FALSE(result.truncated);
+	EXPECT_EQ(again->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 4, 7 }));
+}
+
+TEST(CommandJournalTest, TornHeaderIsTreatedAsEmpty)
+{
+	auto path = JournalTestPath("torn_header");
+	{
+		// ģдļͷʱֻд˲ħ
+		std::ofstream out(path, std::ios::binary);
+		out.write(JournalFormat::MagicBytes, 3);
+	}
+
+	auto arch = std::make_shared<JournalArchitecture>();
+	arch->InitArchitecture();
+	auto result = ReplayCommandJournal(*arch, path);
+	EXPECT_TRUE(result.truncated);
+	EXPECT_EQ(result.replayed, 0u);
+
+	arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+	arch->SendCommand<JournaledAddScoreCommand>(7);
+	arch->DisableCommandJournal();
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	result = ReplayCommandJournal(*restored, path);
+	EXPECT_FALSE(result.truncated);
+	EXPECT_EQ(result.replayed, 1u);
+	EXPECT_EQ(restored->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 7 }));
+
+	// ħǰ׺ĶļȻܾ
+	auto invalid = JournalTestPath("short_invalid");
+	{
+		std::ofstream out(invalid, std::ios::binary);
+		out << "JX";
+	}
+	EXPECT_THROW(CommandJournal journal(invalid), CommandJournalException);
+}
+
+TEST(CommandJournalTest, GroupCommitUnderConcurrentSenders)
+{
+	auto path = JournalTestPath("group");
+	constexpr int threads = 4;
+	constexpr int perThread = 200;
+	{
+		auto arch = std::make_shared<JournalArchitecture>();
+		arch->InitArchitecture();
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path, JournalDurability::Sync));
+		std::vector<std::thread> senders;
+		for (int t = 0; t < threads; ++t)
+		{
+			senders.emplace_back([&]
+				{
+					for (int i = 0; i < perThread; ++i)
+						arch->SendCommand<JournaledCountCommand>();
+				});
+		}
+		for (auto& sender : senders)
+			sender.join();
+
+		auto stats = arch->GetCommandJournal()->GetStats();
+		EXPECT_EQ(stats.recordsAppended, static_cast<uint64_t>(threads * perThread));
+		EXPECT_LE(stats.syncCount, stats.recordsAppended);
+	}
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	EXPECT_EQ(ReplayCommandJournal(*restored, path).replayed, static_cast<size_t>(threads * perThread));
+	EXPECT_EQ(restored->GetModel<JournalCounterModel>()->total.load(), threads * perThread);
+}
+
+TEST(CommandJournalTest, ConcurrentCommandsReplayInExecutionOrder)
+{
+	auto path = JournalTestPath("order");
+	constexpr int threads = 4;
+	constexpr int perThread = 200;
+	std::vector<int> executed;
+	{
+		auto arch = std::make_shared<JournalArchitecture>();
+		arch->InitArchitecture();
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path, JournalDurability::Sync));
+		std::vector<std::thread> senders;
+		for (int t = 0; t < threads; ++t)
+		{
+			senders.emplace_back([&, t]
+				{
+					for (int i = 0; i < perThread; ++i)
+						arch->SendCommand<JournaledOrderCommand>(t * perThread + i);
+				});
+		}
+		for (auto& sender : senders)
+			sender.join();
+		executed = arch->GetModel<JournalOrderModel>()->values;
+	}
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	ReplayCommandJournal(*restored, path);
+	EXPECT_EQ(executed.size(), static_cast<size_t>(threads * perThread));
+	EXPECT_EQ(restored->GetModel<JournalOrderModel>()->values, executed);
+}
+
+// ڼ־
+TEST(CommandJournalTest, EnableAndDisableWhileSending)
+{
+	auto path = JournalTestPath("toggle");
+	auto arch = std::make_shared<JournalArchitecture>();
+	arch->InitArchitecture();
+	std::atomic<bool> stop { false };
+	std::thread sender([&]
+		{
+			while (!stop.load())
+				arch->SendCommand<JournaledCountCommand>();
+		});
+	for (int i = 0; i < 20; ++i)
+	{
+		arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		arch->DisableCommandJournal();
+	}
+	stop = true;
+	sender.join();
+	EXPECT_EQ(arch->GetCommandJournal(), nullptr);
+}
+
+TEST(CommandJournalTest, AsyncAppendsAreBatched)
+{
+	auto path = JournalTestPath("async");
+	auto arch = std::make_shared<JournalArchitecture>();
+	arch->InitArchitecture();
+	arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+	for (int i = 0; i < 1000; ++i)
+		arch->SendCommand<JournaledCountCommand>();
+	arch->GetCommandJournal()->Flush();
+	auto stats = arch->GetCommandJournal()->GetStats();
+	EXPECT_EQ(stats.recordsAppended, 1000u);
+	EXPECT_LT(stats.syncCount, stats.recordsAppended);
+}
+
+// ڵȴ첽ɣ߳ϵȴ
+class AwaitAsyncCountCommand : public AbstractCommand
+{
+protected:
+	void OnExecute() override { SendCommandAsync<JournaledCountCommand>().get(); }
+};
+
+TEST(CommandJournalTest, CommandAwaitsAsyncCommand)
+{
+	auto path = JournalTestPath("await");
+	auto arch = std::make_shared<JournalArchitecture>();
+	arch->InitArchitecture();
+	arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+	arch->SendCommand<AwaitAsyncCountCommand>();
+	EXPECT_EQ(arch->GetModel<JournalCounterModel>()->total.load(), 1);
+
+	// л첽Ϊ¼
+	arch->GetCommandJournal()->Flush();
+	EXPECT_EQ(arch->GetCommandJournal()->GetStats().recordsAppended, 1u);
+}
+
+TEST(CommandJournalTest, InvalidJournalsThrow)
+{
+	auto path = JournalTestPath("invalid");
+	{
+		std::ofstream out(path, std::ios::binary);
+		out << "not a journal";
+	}
+	auto arch = std::make_shared<MyArchitecture>();
+	EXPECT_THROW(ReplayCommandJournal(*arch, path), CommandJournalException);
+
+	// δע
+	auto unknown = JournalTestPath("unknown");
+	{
+		auto writer = std::make_shared<JournalArchitecture>();
+		writer->InitArchitecture();
+		writer->EnableCommandJournal(std::make_shared<CommandJournal>(unknown));
+		writer->SendCommand<JournaledAddScoreCommand>(1);
+	}
+	EXPECT_THROW(ReplayCommandJournal(*arch, unknown), ComponentNotRegisteredException);
+}
+
+// ========== ܹ ==========
+class HandleProbeCommand : public AbstractCommand
+{
+public:
+	IArchitecture* handleDuringExecute = nullptr;
+	std::shared_ptr<IArchitecture> archDuringExecute;
+	int scoreCount = 0;
+
+protected:
+	void OnExecute() override
+	{
+		handleDuringExecute = GetArchitectureHandle();
+		archDuringExecute = GetArchitecture().lock();
+		scoreCount = static_cast<int>(GetModel<ScoreModel>()->scores.size());
+	}
+};
+
+class HandleProbeQuery : public AbstractQuery<IArchitecture*>
+{
+protected:
+	IArchitecture* OnDo() override
+	{
+		GetModel<ScoreModel>();
+		return GetArchitectureHandle();
+	}
+};
+
+TEST(ArchitectureHandleTest, RegisteredComponentsUseHandle)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	auto model = arch->GetModel<ScoreModel>();
+	EXPECT_EQ(model->GetArchitectureHandle(), arch.get());
+	EXPECT_EQ(model->GetArchitecture().lock(), arch);
+}
+
+TEST(ArchitectureHandleTest, CommandsAndQueriesHoldHandleOnlyWhileRunning)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	long useCount = arch.use_count();
+
+	HandleProbeCommand command;
+	arch->ExecuteCommand(command);
+	EXPECT_EQ(command.handleDuringExecute, arch.get());
+	EXPECT_EQ(command.archDuringExecute, arch);
+	EXPECT_EQ(command.scoreCount, 3);
+	EXPECT_EQ(command.GetArchitectureHandle(), nullptr);
+	command.archDuringExecute.reset();
+	EXPECT_EQ(arch.use_count(), useCount);
+
+	EXPECT_EQ(arch->SendQuery<HandleProbeQuery>(), arch.get());
+	EXPECT_EQ(arch.use_count(), useCount);
+}
+
+TEST(ArchitectureHandleTest, HandleClearedWhenArchitectureDestroyed)
+{
+	std::shared_ptr<ScoreModel> model;
+	{
+		auto arch = std::make_shared<ScoreArchitecture>();
+		arch->InitArchitecture();
+		model = arch->GetModel<ScoreModel>();
+	}
+	EXPECT_EQ(model->GetArchitectureHandle(), nullptr);
+	EXPECT_TRUE(model->GetArchitecture().expired());
+	EXPECT_THROW(model->GetModel<ScoreModel>(), ArchitectureNotSetException);
+}
+
+TEST(ArchitectureHandleTest, CustomComponentsFallBackToSharedArchitecture)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	ArchTestCommand command;
+	arch->ExecuteCommand(command);
+	EXPECT_TRUE(command.executed);
+	// δʵ־ͨ SetArchitecture ӵʽ
+	EXPECT_EQ(command.GetArchitecture().lock(), arch);
+}
+
+// ͨӵöд Model
+class RefProbeCommand : public AbstractCommand
+{
+public:
+	ScoreModel* model = nullptr;
+
+protected:
+	void OnExecute() override
+	{
+		model = &GetModelRef<ScoreModel>();
+		model->scores.push_back(4);
+	}
+};
+
+class RefRatingCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override { GetModelRef<RatingModel>().rating = 8; }
+};
+
+TEST(ArchitectureHandleTest, ComponentRefsAvoidSharedOwnership)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	auto system = std::make_shared<TestSystem>();
+	arch->RegisterSystem(system);
+	auto model = arch->GetModel<ScoreModel>();
+	long modelUseCount = model.use_count();
+	long systemUseCount = system.use_count();
+
+	EXPECT_EQ(&arch->GetModelRef<ScoreModel>(), model.get());
+	EXPECT_EQ(&arch->GetModelRef<ScoreModel>(), model.get());
+	EXPECT_EQ(&arch->GetSystemRef<TestSystem>(), system.get());
+	EXPECT_EQ(model.use_count(), modelUseCount);
+	EXPECT_EQ(system.use_count(), systemUseCount);
+	EXPECT_THROW(arch->GetModelRef<TestModel>(), ComponentNotRegisteredException);
+
+	// δдϵͨ÷ʣͬ Model 汾
+	uint64_t version = model->GetVersion();
+	RefProbeCommand command;
+	arch->ExecuteCommand(command);
+	EXPECT_EQ(command.model, model.get());
+	EXPECT_EQ(model->GetVersion(), version + 1);
+	EXPECT_EQ(model.use_count(), modelUseCount);
+}
+
+TEST(ArchitectureHandleTest, ComponentRefCacheFollowsArchitecture)
+{
+	auto first = std::make_shared<ScoreArchitecture>();
+	first->InitArchitecture();
+	auto second = std::make_shared<ScoreArchitecture>();
+	second->InitArchitecture();
+	EXPECT_EQ(&first->GetModelRef<ScoreModel>(), first->GetModel<ScoreModel>().get());
+	EXPECT_EQ(&second->GetModelRef<ScoreModel>(), second->GetModel<ScoreModel>().get());
+	EXPECT_EQ(&first->GetModelRef<ScoreModel>(), first->GetModel<ScoreModel>().get());
+
+	// ע²
+	auto late = std::make_shared<TestModel>();
+	EXPECT_THROW(first->GetModelRef<TestModel>(), ComponentNotRegisteredException);
+	first->RegisterModel(late);
+	EXPECT_EQ(&first->GetModelRef<TestModel>(), late.get());
+}
+
+TEST(ArchitectureHandleTest, ComponentRefsAreRecordedForUndo)
+{
+	auto arch = std::make_shared<RatedArchitecture>();
+	arch->InitArchitecture();
+	arch->SendCommand<RefRatingCommand>();
+	EXPECT_EQ(arch->GetModel<RatingModel>()->rating.GetValue(), 8);
+	EXPECT_TRUE(arch->Undo());
+	EXPECT_EQ(arch->GetModel<RatingModel>()->rating.GetValue(), 3);
+}
+
+// ڼܹڼ䷴ʼʱʼܹ
+class DeinitProbeSystem : public AbstractSystem
+{
+public:
+	bool* lockedNull = nullptr;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override { *lockedNull = GetArchitecture().lock() == nullptr; }
+	void OnEvent(std::shared_ptr<IEvent>) override {}
+};
+
+class DeinitOnDestroyArchitecture : public Architecture
+{
+public:
+	explicit DeinitOnDestroyArchitecture(bool* lockedNull) : mLockedNull(lockedNull) {}
+	~DeinitOnDestroyArchitecture() override { Deinit(); }
+
+protected:
+	void Init() override
+	{
+		auto system = std::make_shared<DeinitProbeSystem>();
+		system->lockedNull = mLockedNull;
+		RegisterSystem(system);
+	}
+
+private:
+	bool* mLockedNull;
+};
+
+TEST(ArchitectureHandleTest, GetArchitectureIsEmptyDuringDestruction)
+{
+	bool lockedNull = false;
+	{
+		auto arch = std::make_shared<DeinitOnDestroyArchitecture>(&lockedNull);
+		arch->InitArchitecture();
+		EXPECT_NE(arch->GetSystem<DeinitProbeSystem>()->GetArchitecture().lock(), nullptr);
+	}
+	EXPECT_TRUE(lockedNull);
+}
+
+// ========== ջϲѯ ==========
+
+class ScoreCountQuery : public AbstractQuery<size_t>
+{
+public:
+	explicit ScoreCountQuery(int offset) : mOffset(offset) {}
+
+protected:
+	size_t OnDo() override { return GetModel<ScoreModel>()->scores.size() + mOffset; }
+
+private:
+	int mOffset;
+};
+
+class ScoreCountForwardQuery : public AbstractQuery<size_t>
+{
+protected:
+	size_t OnDo() override { return SendQuery<ScoreCountQuery>(1); }
+};
+
+TEST(StackQueryTest, SendQueryDoesNotAllocate)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	EXPECT_EQ(arch->SendQuery<ScoreCountQuery>(0), 3u);
+
+	uint64_t before = AllocationTracker::GetThreadAllocationCount();
+	size_t total = 0;
+	for (int i = 0; i < 1000; ++i)
+	{
+		total += arch->SendQuery<ScoreCountQuery>(i);
+		// ڷ͵Ĳѯͬ
+		total += arch->SendQuery<ScoreCountForwardQuery>();
+	}
+	EXPECT_EQ(AllocationTracker::GetThreadAllocationCount() - before, 0u);
+	EXPECT_EQ(total, 1000u * 3 + 999u * 1000 / 2 + 1000u * 4);
+}
+
+// ַŻĳ
+class LongNamedInventoryModel : public AbstractModel
+{
+public:
+	int items = 5;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class InventoryItemsQuery : public AbstractQuery<int>
+{
+protected:
+	int OnDo() override { return GetModel<LongNamedInventoryModel>()->items; }
+};
+
+TEST(StackQueryTest, LongModelTypeNameDoesNotAllocate)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	arch->RegisterModel(std::make_shared<LongNamedInventoryModel>());
+	EXPECT_EQ(arch->SendQuery<InventoryItemsQuery>(), 5);
+
+	uint64_t before = AllocationTracker::GetThreadAllocationCount();
+	for (int i = 0; i < 100; ++i)
+		arch->SendQuery<InventoryItemsQuery>();
+	EXPECT_EQ(AllocationTracker::GetThreadAllocationCount() - before, 0u);
+}
+
+TEST(StackQueryTest, ResultIsMovedOut)
+{
+	class BigResultQuery : public AbstractQuery<std::vector<int>>
+	{
+	protected:
+		std::vector<int> OnDo() override { return std::vector<int>(1000, 7); }
+	};
+
+	auto arch = std::make_shared<MyArchitecture>();
+	uint64_t before = AllocationTracker::GetThreadAllocationCount();
+	auto result = arch->SendQuery<BigResultQuery>();
+	// ֻнһη
+	EXPECT_EQ(AllocationTracker::GetThreadAllocationCount() - before, 1u);
+	EXPECT_EQ(result.size(), 1000u);
+}
+
+// ========== ϵͳµȲ ==========
+class HealthModel : public AbstractModel
+{
+public:
+	int health = 100;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+template <int _Id>
+class TickSystem : public AbstractSystem
+{
+public:
+	std::function<void(ModelAccess&)> declare;
+	std::function<void(float)> update;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+	void OnEvent(std::shared_ptr<IEvent>) override {}
+
+	// δ update ϵͳÿ֡
+	bool OnDeclareUpdate(ModelAccess& access) override
+	{
+		if (declare)
+			declare(access);
+		return static_cast<bool>(update);
+	}
+
+	void OnUpdate(float deltaTime) override { update(deltaTime); }
+};
+
+class TickArchitecture : public Architecture
+{
+protected:
+	void Init() override
+	{
+		RegisterModel(std::make_shared<ScoreModel>());
+		RegisterModel(std::make_shared<HealthModel>());
+	}
+};
+
+TEST(ModelAccessTest, ConflictRules)
+{
+	ModelAccess readScore, readScore2, writeScore, writeHealth, exclusive;
+	readScore.Read<ScoreModel>();
+	readScore2.Read<ScoreModel>();
+	writeScore.Write<ScoreModel>();
+	writeHealth.Write<HealthModel>().Read<ScoreModel>();
+	exclusive.Exclusive();
+
+	EXPECT_FALSE(readScore.ConflictsWith(readScore2));
+	EXPECT_TRUE(readScore.ConflictsWith(writeScore));
+	EXPECT_TRUE(writeScore.ConflictsWith(readScore));
+	EXPECT_FALSE(readScore.ConflictsWith(writeHealth));
+	EXPECT_TRUE(writeScore.ConflictsWith(writeHealth));
+	EXPECT_TRUE(exclusive.ConflictsWith(ModelAccess()));
+}
+
+TEST(SystemSchedulerTest, BatchesFollowDeclaredAccess)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	arch->InitArchitecture();
+	auto readA = std::make_shared<TickSystem<0>>();
+	auto readB = std::make_shared<TickSystem<1>>();
+	auto writer = std::make_shared<TickSystem<2>>();
+	auto other = std::make_shared<TickSystem<3>>();
+	auto idle = std::make_shared<TickSystem<4>>();
+	readA->declare = [](ModelAccess& a) { a.Read<ScoreModel>(); };
+	readB->declare = [](ModelAccess& a) { a.Read<ScoreModel>(); };
+	writer->declare = [](ModelAccess& a) { a.Write<ScoreModel>(); };
+	other->declare = [](ModelAccess& a) { a.Write<HealthModel>(); };
+	readA->update = readB->update = writer->update = other->update = [](float) {};
+	arch->RegisterSystem(readA);
+	arch->RegisterSystem(readB);
+	arch->RegisterSystem(writer);
+	arch->RegisterSystem(other);
+	arch->RegisterSystem(idle);
+
+	auto batches = arch->GetSystemBatches();
+	ASSERT_EQ(batches.size(), 2u);
+	EXPECT_EQ(batches[0], (std::vector<ISystem*> { readA.get(), readB.get(), other.get() }));
+	EXPECT_EQ(batches[1], (std::vector<ISystem*> { writer.get() }));
+}
+
+TEST(SystemSchedulerTest, NonConflictingSystemsUpdateInParallel)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	arch->SetAsyncThreadCount(2);
+	arch->InitArchitecture();
+	auto a = std::make_shared<TickSystem<0>>();
+	auto b = std::make_shared<TickSystem<1>>();
+	a->declare = [](ModelAccess& access) { access.Write<ScoreModel>(); };
+	b->declare = [](ModelAccess& access) { access.Write<HealthModel>(); };
+	std::atomic<int> arrived { 0 };
+	std::atomic<bool> rendezvous { true };
+	auto update = [&](float)
+	{
+		// ϵͳͬʱвܶ
+		++arrived;
+		auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+		while (arrived.load() < 2 && std::chrono::steady_clock::now() < deadline)
+			std::this_thread::yield();
+		if (arrived.load() < 2)
+			rendezvous = false;
+	};
+	a->update = update;
+	b->update = update;
+	arch->RegisterSystem(a);
+	arch->RegisterSystem(b);
+
+	arch->Tick(0.016f);
+	EXPECT_EQ(arrived.load(), 2);
+	EXPECT_TRUE(rendezvous.load());
+}
+
+TEST(SystemSchedulerTest, ConflictingSystemsKeepRegistrationOrder)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	arch->SetAsyncThreadCount(2);
+	arch->InitArchitecture();
+	std::vector<int> order;
+	auto first = std::make_shared<TickSystem<0>>();
+	auto second = std::make_shared<TickSystem<1>>();
+	auto third = std::make_shared<TickSystem<2>>();
+	first->declare = [](ModelAccess& a) { a.Write<ScoreModel>(); };
+	second->declare = [](ModelAccess& a) { a.Read<ScoreModel>().Write<HealthModel>(); };
+	third->declare = [](ModelAccess& a) { a.Exclusive(); };
+	first->update = [&](float) { order.push_back(1); };
+	second->update = [&](float) { order.push_back(2); };
+	third->update = [&](float) { order.push_back(3); };
+	arch->RegisterSystem(third);
+	arch->RegisterSystem(first);
+	arch->RegisterSystem(second);
+
+	arch->Tick();
+	arch->Tick();
+	EXPECT_EQ(order, (std::vector<int> { 3, 1, 2, 3, 1, 2 }));
+}
+
+TEST(SystemSchedulerTest, UpdatePassesDeltaTimeAndBumpsWrittenModels)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	arch->InitArchitecture();
+	auto system = std::make_shared<TickSystem<0>>();
+	float received = 0.0f;
+	system->declare = [](ModelAccess& a) { a.Read<ScoreModel>().Write<HealthModel>(); };
+	system->update = [&](float deltaTime)
+	{
+		received = deltaTime;
+		throw std::runtime_error("update failed");
+	};
+	arch->RegisterSystem(system);
+	auto score = arch->GetModel<ScoreModel>();
+	auto health = arch->GetModel<HealthModel>();
+	auto scoreVersion = score->GetVersion();
+	auto healthVersion = health->GetVersion();
+
+	EXPECT_NO_THROW(arch->Tick(0.5f));
+	EXPECT_FLOAT_EQ(received, 0.5f);
+	EXPECT_EQ(score->GetVersion(), scoreVersion);
+	EXPECT_EQ(health->GetVersion(), healthVersion + 1);
+}
+
+// ϵͳдʱͬʱһ̵߳ȴд
+TEST(SystemSchedulerTest, UpdateSendsCommandWithJournalEnabled)
+{
+	auto path = JournalTestPath("system");
+	auto arch = std::make_shared<JournalArchitecture>();
+	arch->SetAsyncThreadCount(2);
+	arch->InitArchitecture();
+	arch->EnableCommandJournal(std::make_shared<CommandJournal>(path));
+	auto system = std::make_shared<TickSystem<0>>();
+	system->declare = [](ModelAccess& a) { a.Write<JournalOrderModel>(); };
+	system->update = [&](float) { arch->SendCommand<JournaledOrderCommand>(-1); };
+	arch->RegisterSystem(system);
+
+	std::atomic<bool> stop { false };
+	std::thread sender([&]
+		{
+			for (int i = 0; !stop.load(); ++i)
+				arch->SendCommand<JournaledOrderCommand>(i);
+		});
+	constexpr int ticks = 200;
+	for (int i = 0; i < ticks; ++i)
+		arch->Tick();
+	stop = true;
+	sender.join();
+
+	auto& values = arch->GetModel<JournalOrderModel>()->values;
+	EXPECT_EQ(std::count(values.begin(), values.end(), -1), ticks);
+	arch->DisableCommandJournal();
+
+	auto restored = std::make_shared<JournalArchitecture>();
+	restored->InitArchitecture();
+	ReplayCommandJournal(*restored, path);
+	EXPECT_EQ(restored->GetModel<JournalOrderModel>()->values, values);
+}
+
+TEST(SystemSchedulerTest, SystemsUpdateOnlyAfterInit)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	auto system = std::make_shared<TickSystem<0>>();
+	int updates = 0;
+	system->update = [&](float) { ++updates; };
+	arch->RegisterSystem(system);
+
+	arch->Tick();
+	EXPECT_EQ(updates, 0);
+	arch->InitArchitecture();
+	arch->Tick();
+	EXPECT_EQ(updates, 1);
+}
+
+// ========== ҵϵͳ ==========
+TEST(JobSystemTest, ParallelForVisitsEachIndexOnce)
+{
+	JobSystem jobs(3);
+	std::vector<std::atomic<int>> hits(10000);
+	jobs.ParallelFor(0, hits.size(), 64, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+				++hits[i];
+		});
+	for (auto& hit : hits)
+		ASSERT_EQ(hit.load(), 1);
+
+	// Զз
+	std::atomic<size_t> sum { 0 };
+	jobs.ParallelFor(10, 110, 0, [&](size_t first, size_t last)
+		{
+			for (size_t i = first; i < last; ++i)
+				sum += i;
+		});
+	EXPECT_EQ(sum.load(), 5950u);
+}
+
+TEST(JobSystemTest, ParallelForRethrowsException)
+{
+	JobSystem jobs(2);
+	EXPECT_THROW(jobs.ParallelFor(0, 100, 1, [](size_t first, size_t)
+		{
+			if (first == 50)
+				throw std::runtime_error("block failed");
+		}), std::runtime_error);
+}
+
+TEST(JobSystemTest, NestedParallelForOnSingleWorker)
+{
+	JobSystem jobs(1);
+	std::atomic<int> count { 0 };
+	std::promise<void> done;
+	jobs.Post([&]
+		{
+			jobs.ParallelFor(0, 8, 1, [&](size_t, size_t)
+				{
+					jobs.ParallelFor(0, 8, 1, [&](size_t, size_t) { ++count; });
+				});
+			done.set_value();
+		});
+	ASSERT_EQ(done.get_future().wait_for(std::chrono::seconds(5)), std::future_status::ready);
+	EXPECT_EQ(count.load(), 64);
+}
+
+TEST(JobSystemTest, IdleWorkerStealsLocalJobs)
+{
+	JobSystem jobs(2);
+	std::atomic<bool> stolen { false };
+	std::thread::id ownerThread, thiefThread;
+	std::promise<void> done;
+	jobs.Post([&]
+		{
+			ownerThread = std::this_thread::get_id();
+			// ѹ뱾̶߳кִУֻܱһ߳ȡ
+			jobs.Post([&]
+				{
+					thiefThread = std::this_thread::get_id();
+					stolen = true;
+				});
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+			while (!stolen.load() && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::yield();
+			done.set_value();
+		});
+	done.get_future().wait();
+	ASSERT_TRUE(stolen.load());
+	EXPECT_NE(ownerThread, thiefThread);
+}
+
+TEST(JobSystemTest, ComponentsShareArchitectureJobSystem)
+{
+	auto arch = std::make_shared<TickArchitecture>();
+	arch->SetAsyncThreadCount(3);
+	arch->InitArchitecture();
+	EXPECT_EQ(arch->GetJobSystem().ThreadCount(), 3u);
+
+	auto system = std::make_shared<TickSystem<0>>();
+	arch->RegisterSystem(system);
+	EXPECT_EQ(&system->GetJobSystem(), &arch->GetJobSystem());
+
+	TickSystem<1> detached;
+	EXPECT_THROW(detached.GetJobSystem(), ArchitectureNotSetException);
+}
+
+// ========== ̵߳ȣDispatcher ==========
+TEST(DispatcherTest, ConcurrentProducersKeepPerProducerOrder)
+{
+	Dispatcher dispatcher;
+	constexpr int producers = 4;
+	constexpr int perProducer = 1000;
+	std::vector<std::vector<int>> received(producers);
+	std::vector<std::thread> threads;
+	for (int p = 0; p < producers; ++p)
+	{
+		threads.emplace_back([&, p]
+			{
+				for (int i = 0; i < perProducer; ++i)
+					dispatcher.Post([&, p, i] { received[p].push_back(i); });
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(dispatcher.PendingCount(), static_cast<size_t>(producers * perProducer));
+	EXPECT_EQ(dispatcher.Pump(), static_cast<size_t>(producers * perProducer));
+	EXPECT_EQ(dispatcher.PendingCount(), 0u);
+	for (auto& values : received)
+	{
+		ASSERT_EQ(values.size(), static_cast<size_t>(perProducer));
+		EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+	}
+}
+
+TEST(DispatcherTest, TasksPostedDuringPumpRunOnNextPump)
+{
+	Dispatcher dispatcher;
+	int runs = 0;
+	dispatcher.Post([&]
+		{
+			++runs;
+			dispatcher.Post([&] { ++runs; });
+		});
+	dispatcher.Post([] { throw std::runtime_error("ignored"); });
+
+	EXPECT_EQ(dispatcher.Pump(), 2u);
+	EXPECT_EQ(runs, 1);
+	EXPECT_EQ(dispatcher.Pump(), 1u);
+	EXPECT_EQ(runs, 2);
+	EXPECT_EQ(dispatcher.Pump(), 0u);
+}
+
+class AffinityController : public AbstractController
+{
+public:
+	explicit AffinityController(std::shared_ptr<IArchitecture> arch) : mArch(arch) {}
+	std::vector<std::thread::id> handledOn;
+
+	std::weak_ptr<IArchitecture> GetArchitecture() const override { return mArch; }
+
+protected:
+	void OnEvent(std::shared_ptr<IEvent>) override { handledOn.push_back(std::this_thread::get_id()); }
+
+private:
+	std::weak_ptr<IArchitecture> mArch;
+};
+
+class ThreadIdCommand : public AbstractCommand
+{
+public:
+	explicit ThreadIdCommand(std::thread::id* executedOn) : mExecutedOn(executedOn) {}
+
+protected:
+	void OnExecute() override { *mExecutedOn = std::this_thread::get_id(); }
+
+private:
+	std::thread::id* mExecutedOn;
+};
+
+TEST(DispatcherTest, ControllerEventsRunOnOwningThread)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	Dispatcher uiDispatcher;
+	AffinityController controller(arch);
+	TestHandler direct;
+	controller.SetEventDispatcher(&uiDispatcher);
+	controller.RegisterEvent<TestEvent>(&controller);
+	arch->RegisterEvent<TestEvent>(&direct);
+
+	std::thread worker([&] { arch->SendEvent(std::make_shared<TestEvent>()); });
+	worker.join();
+	EXPECT_TRUE(direct.handled);
+	EXPECT_TRUE(controller.handledOn.empty());
+
+	EXPECT_EQ(uiDispatcher.Pump(), 1u);
+	ASSERT_EQ(controller.handledOn.size(), 1u);
+	EXPECT_EQ(controller.handledOn[0], std::this_thread::get_id());
+}
+
+TEST(DispatcherTest, UnRegisteredHandlerSkipsQueuedEvents)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	Dispatcher uiDispatcher;
+	AffinityController controller(arch);
+	controller.SetEventDispatcher(&uiDispatcher);
+	controller.RegisterEvent<TestEvent>(&controller);
+
+	arch->SendEvent(std::make_shared<TestEvent>());
+	controller.UnRegisterEvent<TestEvent>(&controller);
+	uiDispatcher.Pump();
+	EXPECT_TRUE(controller.handledOn.empty());
+}
+
+TEST(DispatcherTest, PostCommandRunsOnPumpThread)
+{
+	auto arch = std::make_shared<MyArchitecture>();
+	Dispatcher uiDispatcher;
+	std::thread::id executedOn;
+	std::thread worker([&] { arch->PostCommand<ThreadIdCommand>(uiDispatcher, &executedOn); });
+	worker.join();
+	EXPECT_EQ(executedOn, std::thread::id());
+
+	uiDispatcher.Pump();
+	EXPECT_EQ(executedOn, std::this_thread::get_id());
+
+	// ܹٺͶݵ
+	arch->PostCommand<ThreadIdCommand>(uiDispatcher, &executedOn);
+	executedOn = std::thread::id();
+	arch.reset();
+	uiDispatcher.Pump();
+	EXPECT_EQ(executedOn, std::thread::id());
+}
+
+// ========== ʱ ==========
+TEST(TimerServiceTest, FiresOnExpiryTickNotBefore)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	using std::chrono::milliseconds;
+	std::vector<int> fired;
+	// ֱڵ 0123 
+	timers->Schedule(milliseconds(5), [&] { fired.push_back(0); });
+	timers->Schedule(milliseconds(300), [&] { fired.push_back(1); });
+	timers->Schedule(milliseconds(70000), [&] { fired.push_back(2); });
+	timers->Schedule(milliseconds(20000000), [&] { fired.push_back(3); });
+
+	for (auto [expiry, id] : { std::pair<long long, int> { 5, 0 }, { 300, 1 }, { 70000, 2 }, { 20000000, 3 } })
+	{
+		EXPECT_EQ(timers->Advance(start + milliseconds(expiry - 1)), 0u);
+		EXPECT_EQ(timers->Advance(start + milliseconds(expiry)), 1u);
+		ASSERT_FALSE(fired.empty());
+		EXPECT_EQ(fired.back(), id);
+	}
+	EXPECT_EQ(fired.size(), 4u);
+	EXPECT_EQ(timers->GetActiveCount(), 0u);
+}
+
+TEST(TimerServiceTest, LargeAdvanceFiresInExpiryOrder)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	using std::chrono::milliseconds;
+	std::vector<int> fired;
+	timers->Schedule(milliseconds(70000), [&] { fired.push_back(70000); });
+	timers->Schedule(milliseconds(3), [&] { fired.push_back(3); });
+	TimerId cancelled = timers->Schedule(milliseconds(4), [&] { fired.push_back(4); });
+	timers->Schedule(milliseconds(700), [&] { fired.push_back(700); });
+	timers->Schedule(milliseconds(255), [&] { fired.push_back(255); });
+	timers->Cancel(cancelled);
+
+	// һƽԽȦղ۱˳򲻱
+	EXPECT_EQ(timers->Advance(start + milliseconds(100000)), 4u);
+	EXPECT_EQ(fired, (std::vector<int> { 3, 255, 700, 70000 }));
+}
+
+TEST(TimerServiceTest, CancelAndStaleIds)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	int fired = 0;
+	TimerId id = timers->Schedule(std::chrono::milliseconds(10), [&] { ++fired; });
+	EXPECT_TRUE(timers->Cancel(id));
+	EXPECT_FALSE(timers->Cancel(id));
+
+	// ͬһڵ¶ʱܾɱʶӰ
+	TimerId reused = timers->Schedule(std::chrono::milliseconds(10), [&] { fired += 10; });
+	EXPECT_NE(reused, id);
+	EXPECT_FALSE(timers->Cancel(id));
+	timers->Advance(start + std::chrono::milliseconds(10));
+	EXPECT_EQ(fired, 10);
+	EXPECT_FALSE(timers->Cancel(reused));
+	EXPECT_FALSE(timers->Cancel(0));
+}
+
+TEST(TimerServiceTest, PeriodicTimerRepeatsUntilCancelledFromCallback)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	int fired = 0;
+	TimerId id = 0;
+	id = timers->Schedule(std::chrono::milliseconds(10), [&]
+		{
+			if (++fired == 3)
+				timers->Cancel(id);
+		}, std::chrono::milliseconds(10));
+
+	for (int ms = 1; ms <= 100; ++ms)
+		timers->Advance(start + std::chrono::milliseconds(ms));
+	EXPECT_EQ(fired, 3);
+	EXPECT_EQ(timers->GetActiveCount(), 0u);
+}
+
+TEST(TimerServiceTest, ManyOutstandingTimers)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	constexpr int count = 100000;
+	std::vector<TimerId> ids;
+	ids.reserve(count);
+	int fired = 0;
+	for (int i = 0; i < count; ++i)
+		ids.push_back(timers->Schedule(std::chrono::milliseconds(1 + (i * 7919) % 10000), [&] { ++fired; }));
+	for (int i = 0; i < count; i += 2)
+		EXPECT_TRUE(timers->Cancel(ids[i]));
+	EXPECT_EQ(timers->GetActiveCount(), static_cast<size_t>(count / 2));
+
+	EXPECT_EQ(timers->Advance(start + std::chrono::seconds(5)) + timers->Advance(start + std::chrono::seconds(10)),
+		static_cast<size_t>(count / 2));
+	EXPECT_EQ(fired, count / 2);
+	EXPECT_EQ(timers->GetActiveCount(), 0u);
+}
+
+TEST(TimerServiceTest, TokenCancelsWithUnRegisterTrigger)
+{
+	auto start = std::chrono::steady_clock::now();
+	auto timers = std::make_shared<TimerService>(std::chrono::milliseconds(1), start);
+	int fired = 0;
+	{
+		UnRegisterTrigger trigger;
+		timers->MakeToken(timers->Schedule(std::chrono::milliseconds(1), [&] { ++fired; }))
+			->UnRegisterWhenObjectDestroyed(&trigger);
+	}
+	timers->Advance(start + std::chrono::seconds(1));
+	EXPECT_EQ(fired, 0);
+
+	// ٺԿɰȫע
+	auto token = timers->MakeToken(timers->Schedule(std::chrono::milliseconds(1), [] {}));
+	timers.reset();
+	EXPECT_NO_THROW(token->UnRegister());
+}
+
+class CountingEventHandler : public ICanHandleEvent
+{
+public:
+	int count = 0;
+	void HandleEvent(std::shared_ptr<IEvent>) override { ++count; }
+};
+
+TEST(TimerServiceTest, ArchitectureSendsEventsAndEnqueuesCommands)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	CountingEventHandler handler;
+	arch->RegisterEvent<TestEvent>(&handler);
+
+	arch->SendEventAfter<TestEvent>(std::chrono::nanoseconds(0));
+	arch->EnqueueCommandAfter<AddScoreCommand>(std::chrono::nanoseconds(0), 4);
+	auto heartbeat = arch->EnqueueCommandEvery<AddScoreCommand>(std::chrono::hours(1), 5);
+	arch->Tick();
+	EXPECT_EQ(handler.count, 1);
+	EXPECT_EQ(arch->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 4 }));
+
+	// ÿδ
+	auto now = std::chrono::steady_clock::now();
+	arch->GetTimerService().Advance(now + std::chrono::hours(1));
+	arch->GetTimerService().Advance(now + std::chrono::hours(2));
+	arch->Tick();
+	EXPECT_EQ(arch->GetModel<ScoreModel>()->scores, (std::vector<int> { 1, 2, 3, 4, 5, 5 }));
+
+	heartbeat->UnRegister();
+	arch->GetTimerService().Advance(now + std::chrono::hours(3));
+	arch->Tick();
+	EXPECT_EQ(arch->GetModel<ScoreModel>()->scores.size(), 6u);
+	arch->UnRegisterEvent<TestEvent>(&handler);
+}
+
+// ========== Model д ==========
+class GuardedCounterModel : public AbstractModel
+{
+public:
+	GuardedCounterModel() { EnableAccessGuard(); }
+	int value = 0;
+	std::atomic<int> readers { 0 };
+	std::atomic<int> writers { 0 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class GuardedLogModel : public AbstractModel
+{
+public:
+	GuardedLogModel() { EnableAccessGuard(); }
+	std::vector<int> entries;
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class GuardedArchitecture : public Architecture
+{
+protected:
+	void Init() override
+	{
+		RegisterModel(std::make_shared<GuardedCounterModel>());
+		RegisterModel(std::make_shared<GuardedLogModel>());
+	}
+};
+
+// ȡڼ¼ѡȴһߵ
+class GuardedReadQuery : public AbstractQuery<int>
+{
+public:
+	explicit GuardedReadQuery(std::atomic<int>* arrived = nullptr) : mArrived(arrived) {}
+
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Read<GuardedCounterModel>();
+		return true;
+	}
+
+protected:
+	int OnDo() override
+	{
+		auto model = GetModel<GuardedCounterModel>();
+		++model->readers;
+		int writers = model->writers.load();
+		if (mArrived)
+		{
+			++*mArrived;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+			while (mArrived->load() < 2 && std::chrono::steady_clock::now() < deadline)
+				std::this_thread::yield();
+		}
+		--model->readers;
+		return writers;
+	}
+
+private:
+	std::atomic<int>* mArrived;
+};
+
+class GuardedIncrementCommand : public AbstractCommand
+{
+public:
+	std::atomic<int>* overlaps = nullptr;
+
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Write<GuardedCounterModel>().Write<GuardedLogModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<GuardedCounterModel>();
+		if (++model->writers != 1 || model->readers.load() != 0)
+			++*overlaps;
+		int value = model->value;
+		std::this_thread::yield();
+		model->value = value + 1;
+		GetModel<GuardedLogModel>()->entries.push_back(model->value);
+		// Ƕײѯѳед
+		SendQuery<GuardedReadQuery>();
+		--model->writers;
+	}
+};
+
+class UpgradeCommand : public AbstractCommand
+{
+public:
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Read<GuardedCounterModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override
+	{
+		auto overlaps = std::make_unique<std::atomic<int>>(0);
+		auto nested = std::make_unique<GuardedIncrementCommand>();
+		nested->overlaps = overlaps.get();
+		SendCommand(std::move(nested));
+	}
+};
+
+TEST(ModelAccessGuardTest, DeclaredReadersRunConcurrently)
+{
+	auto arch = std::make_shared<GuardedArchitecture>();
+	arch->InitArchitecture();
+	std::atomic<int> arrived { 0 };
+	std::thread other([&] { arch->SendQuery<GuardedReadQuery>(&arrived); });
+	arch->SendQuery<GuardedReadQuery>(&arrived);
+	other.join();
+	EXPECT_EQ(arrived.load(), 2);
+}
+
+TEST(ModelAccessGuardTest, WritersAreExclusive)
+{
+	auto arch = std::make_shared<GuardedArchitecture>();
+	arch->InitArchitecture();
+	std::atomic<int> overlaps { 0 };
+	std::atomic<int> readsDuringWrite { 0 };
+	constexpr int perThread = 200;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 3; ++t)
+	{
+		threads.emplace_back([&]
+			{
+				for (int i = 0; i < perThread; ++i)
+				{
+					auto command = std::make_unique<GuardedIncrementCommand>();
+					command->overlaps = &overlaps;
+					arch->SendCommand(std::move(command));
+				}
+			});
+	}
+	threads.emplace_back([&]
+		{
+			for (int i = 0; i < perThread; ++i)
+				readsDuringWrite += arch->SendQuery<GuardedReadQuery>();
+		});
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(overlaps.load(), 0);
+	EXPECT_EQ(readsDuringWrite.load(), 0);
+	EXPECT_EQ(arch->GetModel<GuardedCounterModel>()->value, 3 * perThread);
+	EXPECT_EQ(arch->GetModel<GuardedLogModel>()->entries.size(), static_cast<size_t>(3 * perThread));
+}
+
+TEST(ModelAccessGuardTest, NestedUpgradeThrows)
+{
+	auto arch = std::make_shared<GuardedArchitecture>();
+	arch->InitArchitecture();
+	EXPECT_THROW(arch->SendCommand<UpgradeCommand>(), ModelAccessException);
+
+	// ʧܺȫͷ
+	std::atomic<int> overlaps { 0 };
+	auto command = std::make_unique<GuardedIncrementCommand>();
+	command->overlaps = &overlaps;
+	arch->SendCommand(std::move(command));
+	EXPECT_EQ(arch->GetModel<GuardedCounterModel>()->value, 1);
+}
+
+class GuardedValueQuery : public AbstractQuery<int>
+{
+public:
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Read<GuardedCounterModel>();
+		return true;
+	}
+
+	bool IsReadOnly() const override { return true; }
+
+protected:
+	int OnDo() override { return GetModel<GuardedCounterModel>()->value; }
+};
+
+// дʱвѯͬһ Modelѯڵִ߳У̵߳ȴд
+class FanOutUnderWriteCommand : public AbstractCommand
+{
+public:
+	std::pair<int, int>* results = nullptr;
+
+	bool DeclareModelAccess(ModelAccess& access) const override
+	{
+		access.Write<GuardedCounterModel>();
+		return true;
+	}
+
+protected:
+	void OnExecute() override
+	{
+		GetModel<GuardedCounterModel>()->value = 7;
+		std::tie(results->first, results->second) = SendQueries(std::make_unique<GuardedValueQuery>(), std::make_unique<GuardedValueQuery>());
+	}
+};
+
+TEST(ModelAccessGuardTest, SendQueriesUnderHeldWriteGuard)
+{
+	auto arch = std::make_shared<GuardedArchitecture>();
+	arch->InitArchitecture();
+	for (int i = 0; i < 20; ++i)
+	{
+		std::pair<int, int> results;
+		auto command = std::make_unique<FanOutUnderWriteCommand>();
+		command->results = &results;
+		arch->SendCommand(std::move(command));
+		EXPECT_EQ(results, std::make_pair(7, 7));
+	}
+
+	// δʱԲִ
+	auto [a, b] = arch->SendQueries(std::make_unique<GuardedValueQuery>(), std::make_unique<GuardedValueQuery>());
+	EXPECT_EQ(a, 7);
+	EXPECT_EQ(b, 7);
+}
+
+// ========== ׷ٲ ==========
+class TracedEvent : public IEvent
+{
+};
+
+class TracedModel : public AbstractModel
+{
+public:
+	BindableProperty<int> value { 0 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class TracedArchitecture : public Architecture
+{
+protected:
+	void Init() override { RegisterModel(std::make_shared<TracedModel>()); }
+};
+
+class TracedCommand : public AbstractCommand
+{
+protected:
+	void OnExecute() override
+	{
+		GetModel<TracedModel>()->value.SetValue(GetModel<TracedModel>()->value.GetValue() + 1);
+		SendEvent<TracedEvent>();
+	}
+};
+
+class TracedQuery : public AbstractQuery<int>
+{
+protected:
+	int OnDo() override { return GetModel<TracedModel>()->value.GetValue(); }
+};
+
+class TracedHandler : public ICanHandleEvent
+{
+public:
+	void HandleEvent(std::shared_ptr<IEvent>) override { ++count; }
+	int count = 0;
+};
+
+// ͳƵӴֵĴ
+static size_t CountOccurrences(const std::string& text, const std::string& pattern)
+{
+	size_t count = 0;
+	for (size_t pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + 1))
+		++count;
+	return count;
+}
+
+TEST(TracerTest, DisabledRecordsNothing)
+{
+	auto& tracer = Tracer::Instance();
+	tracer.SetEnabled(false);
+	tracer.Clear();
+
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+	arch->SendCommand<TracedCommand>();
+	arch->SendQuery<TracedQuery>();
+	EXPECT_EQ(tracer.GetEventCount(), 0u);
+}
+
+TEST(TracerTest, RecordsFrameworkOperations)
+{
+	auto& tracer = Tracer::Instance();
+	tracer.Clear();
+
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+	TracedHandler handler;
+	arch->RegisterEvent<TracedEvent>(&handler);
+	auto observer = arch->GetModel<TracedModel>()->value.Register([](const int&) {});
+
+	tracer.SetEnabled(true);
+	arch->SendCommand<TracedCommand>();
+	EXPECT_EQ(arch->SendQuery<TracedQuery>(), 1);
+	tracer.SetEnabled(false);
+	arch->SendCommand<TracedCommand>();
+
+	EXPECT_EQ(handler.count, 2);
+	EXPECT_EQ(tracer.GetEventCount(), 5u);
+	std::string json = tracer.ExportChromeTrace();
+	EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+	EXPECT_EQ(CountOccurrences(json, "\"ph\":\"X\""), 5u);
+	EXPECT_EQ(CountOccurrences(json, "\"cat\":\"command\""), 1u);
+	EXPECT_EQ(CountOccurrences(json, "\"cat\":\"query\""), 1u);
+	EXPECT_EQ(CountOccurrences(json, "\"cat\":\"event\""), 1u);
+	EXPECT_EQ(CountOccurrences(json, "\"cat\":\"handler\""), 1u);
+	EXPECT_EQ(CountOccurrences(json, "\"cat\":\"property\""), 1u);
+	EXPECT_NE(json.find("TracedCommand"), std::string::npos);
+	EXPECT_NE(json.find("TracedHandler"), std::string::npos);
+
+	arch->UnRegisterEvent<TracedEvent>(&handler);
+	tracer.Clear();
+}
+
+TEST(TracerTest, ThreadsRecordIntoSeparateBuffers)
+{
+	auto& tracer = Tracer::Instance();
+	tracer.Clear();
+	tracer.SetEnabled(true);
+
+	constexpr int threadCount = 4;
+	constexpr int perThread = 500;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([t]
+			{
+				Tracer::Instance().SetThreadName("worker-" + std::to_string(t));
+				for (int i = 0; i < perThread; ++i)
+				{
+					TraceScope scope("test", "ThreadedSpan");
+				}
+			});
+	}
+	// ¼еֻдļ¼
+	std::string partial = tracer.ExportChromeTrace();
+	for (auto& thread : threads)
+		thread.join();
+	tracer.SetEnabled(false);
+
+	EXPECT_EQ(tracer.GetEventCount(), static_cast<size_t>(threadCount * perThread));
+	std::string json = tracer.ExportChromeTrace();
+	EXPECT_EQ(CountOccurrences(json, "\"name\":\"ThreadedSpan\""), static_cast<size_t>(threadCount * perThread));
+	EXPECT_NE(json.find("\"args\":{\"name\":\"worker-3\"}"), std::string::npos);
+	EXPECT_LE(CountOccurrences(partial, "ThreadedSpan"), static_cast<size_t>(threadCount * perThread));
+	tracer.Clear();
+}
+
+TEST(TracerTest, FullBufferDropsNewRecords)
+{
+	auto& tracer = Tracer::Instance();
+	tracer.Clear();
+	std::thread([&]
+		{
+			for (size_t i = 0; i < Tracer::ChunkSize * Tracer::MaxChunks + 10; ++i)
+				tracer.Record("test", "Overflow", i, i + 1);
+		})
+		.join();
+
+	EXPECT_EQ(tracer.GetEventCount(), Tracer::ChunkSize * Tracer::MaxChunks);
+	EXPECT_EQ(tracer.GetDroppedCount(), 10u);
+	tracer.Clear();
+	EXPECT_EQ(tracer.GetDroppedCount(), 0u);
+}
+
+// ========== ָ ==========
+TEST(MetricsTest, CounterMergesThreadShards)
+{
+	MetricsRegistry registry;
+	auto& counter = registry.GetCounter("test.counter");
+	EXPECT_EQ(&counter, &registry.GetCounter("test.counter"));
+
+	constexpr int threadCount = 8;
+	constexpr int perThread = 10000;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < threadCount; ++t)
+	{
+		threads.emplace_back([&]
+			{
+				for (int i = 0; i < perThread; ++i)
+					counter.Add();
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	EXPECT_EQ(counter.GetValue(), static_cast<uint64_t>(threadCount * perThread));
+	auto& gauge = registry.GetGauge("test.gauge");
+	gauge.Set(10);
+	gauge.Add(-3);
+	auto snapshot = registry.Snapshot();
+	EXPECT_EQ(snapshot.counters["test.counter"], static_cast<uint64_t>(threadCount * perThread));
+	EXPECT_EQ(snapshot.gauges["test.gauge"], 7);
+}
+
+TEST(MetricsTest, HistogramBucketsBoundRelativeError)
+{
+	for (uint64_t value : std::vector<uint64_t> { 0, 1, 31, 32, 33, 1000, 123456789, uint64_t(1) << 40, UINT64_MAX })
+	{
+		size_t index = MetricHistogram::BucketIndex(value);
+		ASSERT_LT(index, MetricHistogram::BucketCount);
+		uint64_t upper = MetricHistogram::BucketUpperBound(index);
+		EXPECT_GE(upper, value);
+		EXPECT_LE(static_cast<double>(upper - value), static_cast<double>(value) / MetricHistogram::SubBucketCount);
+		if (index > 0)
+		{
+			EXPECT_LT(MetricHistogram::BucketUpperBound(index - 1), value);
+		}
+	}
+	EXPECT_EQ(MetricHistogram::BucketIndex(UINT64_MAX), MetricHistogram::BucketCount - 1);
+}
+
+TEST(MetricsTest, HistogramPercentiles)
+{
+	MetricHistogram histogram;
+	std::vector<std::thread> threads;
+	for (int t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&, t]
+			{
+				for (uint64_t value = 1 + t; value <= 1000; value += 4)
+					histogram.Record(value);
+			});
+	}
+	for (auto& thread : threads)
+		thread.join();
+
+	auto snapshot = histogram.Snapshot();
+	EXPECT_EQ(snapshot.count, 1000u);
+	EXPECT_EQ(snapshot.min, 1u);
+	EXPECT_EQ(snapshot.max, 1000u);
+	EXPECT_DOUBLE_EQ(snapshot.Mean(), 500.5);
+	EXPECT_NEAR(static_cast<double>(snapshot.Percentile(50)), 500.0, 500.0 / 16);
+	EXPECT_NEAR(static_cast<double>(snapshot.Percentile(99)), 990.0, 990.0 / 16);
+	EXPECT_EQ(snapshot.Percentile(0), 1u);
+	EXPECT_EQ(snapshot.Percentile(100), 1000u);
+	EXPECT_EQ(MetricHistogram().Snapshot().Percentile(50), 0u);
+}
+
+TEST(MetricsTest, FrameworkMetricsByType)
+{
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+	auto registry = arch->GetUtility<MetricsRegistry>();
+	ASSERT_NE(registry, nullptr);
+
+	// Ĭϲ¼
+	arch->SendCommand<TracedCommand>();
+	EXPECT_EQ(arch->GetFrameworkMetrics(), nullptr);
+	EXPECT_TRUE(registry->Snapshot().histograms.empty());
+
+	arch->EnableFrameworkMetrics();
+	auto before = registry->Snapshot();
+	for (int i = 0; i < 5; ++i)
+		arch->SendCommand<TracedCommand>();
+	arch->SendQuery<TracedQuery>();
+	std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	auto after = registry->Snapshot();
+
+	auto command = after.histograms.find(MetricsRegistry::TypeMetricName(MetricsRegistry::CommandPrefix, typeid(TracedCommand)));
+	ASSERT_NE(command, after.histograms.end());
+	EXPECT_EQ(command->second.count, 5u);
+	EXPECT_GT(command->second.Percentile(99), 0u);
+	auto query = after.histograms.find(MetricsRegistry::TypeMetricName(MetricsRegistry::QueryPrefix, typeid(TracedQuery)));
+	ASSERT_NE(query, after.histograms.end());
+	EXPECT_EQ(query->second.count, 1u);
+
+	std::string events = MetricsRegistry::TypeMetricName(MetricsRegistry::EventPrefix, typeid(TracedEvent));
+	EXPECT_EQ(after.counters[events], 5u);
+	EXPECT_GT(after.Rate(before, events), 0.0);
+	EXPECT_NE(events.find("TracedEvent"), std::string::npos);
+
+	// ÿܹע
+	auto other = std::make_shared<TracedArchitecture>();
+	other->InitArchitecture();
+	other->EnableFrameworkMetrics();
+	other->SendCommand<TracedCommand>();
+	EXPECT_EQ(other->GetUtility<MetricsRegistry>()->Snapshot().counters[events], 1u);
+	EXPECT_EQ(registry->Snapshot().counters[events], 5u);
+}
+
+// ========== ͳƲ ==========
+class AllocatingHandler : public ICanHandleEvent
+{
+public:
+	void HandleEvent(std::shared_ptr<IEvent>) override { buffer = std::make_unique<char[]>(4096); }
+	std::unique_ptr<char[]> buffer;
+};
+
+class AllocatingCommand : public AbstractCommand
+{
+protected:
+	void OnExecute() override
+	{
+		std::vector<char> scratch(4096);
+		GetModel<TracedModel>();
+		SendEvent<TracedEvent>();
+	}
+};
+
+TEST(AllocationTrackerTest, CountsOnlyInsideScopes)
+{
+	AllocationTracker::Reset();
+	// ֮⣬ʡԷ
+	auto outside = std::make_unique<int>(1);
+	std::unique_ptr<std::array<char, 100>> inside;
+	std::unique_ptr<int> ignored;
+	{
+		AllocationScope scope(AllocationOperation::Query);
+		inside = std::make_unique<std::array<char, 100>>();
+		{
+			AllocationScope user(AllocationOperation::None);
+			ignored = std::make_unique<int>(2);
+		}
+	}
+	ASSERT_TRUE(outside && inside && ignored);
+
+	auto stats = AllocationTracker::GetStats(AllocationOperation::Query);
+	EXPECT_EQ(stats.operations, 1u);
+	EXPECT_EQ(stats.allocations, 1u);
+	EXPECT_GE(stats.bytes, 100u);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::None).allocations, 0u);
+	AllocationTracker::Reset();
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::Query).allocations, 0u);
+}
+
+TEST(AllocationTrackerTest, HandlerAllocationsAreNotChargedToSend)
+{
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+	AllocatingHandler handler;
+	arch->RegisterEvent<TracedEvent>(&handler);
+
+	AllocationTracker::Reset();
+	for (int i = 0; i < 10; ++i)
+		arch->SendEvent<TracedEvent>();
+
+	// ¼붩б뷢ͣ 4096 ֽڲ
+	auto stats = AllocationTracker::GetStats(AllocationOperation::SendEvent);
+	EXPECT_EQ(stats.operations, 10u);
+	EXPECT_GE(stats.allocations, 10u);
+	EXPECT_LT(stats.bytes / stats.operations, 4096u);
+	arch->UnRegisterEvent<TracedEvent>(&handler);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::UnRegisterEvent).operations, 1u);
+}
+
+TEST(AllocationTrackerTest, CommandsQueriesAndNestedOperations)
+{
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+
+	AllocationTracker::Reset();
+	for (int i = 0; i < 5; ++i)
+		arch->SendCommand<AllocatingCommand>();
+	for (int i = 0; i < 3; ++i)
+		arch->SendQuery<TracedQuery>();
+
+	auto command = AllocationTracker::GetStats(AllocationOperation::Command);
+	EXPECT_EQ(command.operations, 5u);
+	EXPECT_LT(command.bytes, 5u * 4096u);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::Query).operations, 3u);
+	// ڷ͵¼ȡ Model ԵĲͳ
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::SendEvent).operations, 5u);
+	EXPECT_GE(AllocationTracker::GetStats(AllocationOperation::GetComponent).operations, 8u);
+
+	std::string report = AllocationTracker::Report();
+	EXPECT_NE(report.find("allocs/op"), std::string::npos);
+	EXPECT_NE(report.find("Command"), std::string::npos);
+	EXPECT_NE(report.find("GetComponent"), std::string::npos);
+	EXPECT_EQ(report.find("PropertyRegister"), std::string::npos);
+}
+
+// ==========  ==========
+static LockSiteStats FindLockSite(const std::string& name)
+{
+	for (auto& stats : LockProfiler::Instance().GetStats())
+	{
+		if (stats.name == name)
+			return stats;
+	}
+	return {};
+}
+
+TEST(LockProfilerTest, CountsAcquisitionsAndHoldTime)
+{
+	ProfiledMutex mutex("LockProfilerTest::Uncontended");
+	LockProfiler::Instance().Reset();
+	for (int i = 0; i < 10; ++i)
+	{
+		std::lock_guard<ProfiledMutex> lock(mutex);
+	}
+	EXPECT_TRUE(mutex.try_lock());
+	mutex.unlock();
+
+	auto stats = FindLockSite("LockProfilerTest::Uncontended");
+	EXPECT_EQ(stats.acquisitions, 11u);
+	EXPECT_EQ(stats.contended, 0u);
+	EXPECT_EQ(stats.wait.count(), 0);
+}
+
+TEST(LockProfilerTest, RecordsContentionAndSortsByWait)
+{
+	ProfiledMutex hot("LockProfilerTest::Hot");
+	ProfiledMutex cold("LockProfilerTest::Cold");
+	LockProfiler::Instance().Reset();
+
+	std::atomic<bool> held { false };
+	std::thread holder([&]
+		{
+			std::lock_guard<ProfiledMutex> lock(hot);
+			held = true;
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+		});
+	while (!held)
+		std::this_thread::yield();
+	{
+		std::lock_guard<ProfiledMutex> lock(hot);
+	}
+	holder.join();
+	{
+		std::lock_guard<ProfiledMutex> lock(cold);
+	}
+
+	auto stats = FindLockSite("LockProfilerTest::Hot");
+	EXPECT_EQ(stats.acquisitions, 2u);
+	EXPECT_EQ(stats.contended, 1u);
+	EXPECT_GE(stats.wait, std::chrono::milliseconds(5));
+	EXPECT_EQ(stats.maxWait, stats.wait);
+	EXPECT_GE(stats.hold, std::chrono::milliseconds(15));
+
+	auto all = LockProfiler::Instance().GetStats();
+	ASSERT_FALSE(all.empty());
+	EXPECT_EQ(all.front().name, "LockProfilerTest::Hot");
+	std::string report = LockProfiler::Instance().Report();
+	EXPECT_LT(report.find("LockProfilerTest::Hot"), report.find("LockProfilerTest::Cold"));
+}
+
+TEST(LockProfilerTest, FrameworkMutexesReportBySite)
+{
+	auto arch = std::make_shared<TracedArchitecture>();
+	arch->InitArchitecture();
+	TracedHandler handler;
+	arch->RegisterEvent<TracedEvent>(&handler);
+	LockProfiler::Instance().Reset();
+
+	arch->SendCommand<TracedCommand>();
+	arch->SendQuery<TracedQuery>();
+
+	EXPECT_EQ(FindLockSite("EventBus::mMutex").acquisitions, 1u);
+	EXPECT_GE(FindLockSite("IOCContainer::mModelMutex").acquisitions, 3u);
+	EXPECT_GE(FindLockSite("BindableProperty::mMutex").acquisitions, 1u);
+	std::string report = LockProfiler::Instance().Report();
+	EXPECT_NE(report.find("EventBus::mMutex"), std::string::npos);
+	EXPECT_EQ(report.find("IOCContainer::mSystemMutex"), std::string::npos);
+	arch->UnRegisterEvent<TracedEvent>(&handler);
+}
+
+#if JFRAMEWORK_HAS_COROUTINES
+// ========== Э/ѯ ==========
+class ScoreAddedEvent : public IEvent
+{
+public:
+	explicit ScoreAddedEvent(int v) : value(v) {}
+	int value;
+};
+
+class WaitScoreCommand : public AbstractCoroutineCommand
+{
+public:
+	explicit WaitScoreCommand(int* out) : mOut(out) {}
+
+protected:
+	Task<void> OnExecuteAsync() override
+	{
+		auto event = co_await WaitEvent<ScoreAddedEvent>();
+		GetModel<ScoreModel>()->scores.push_back(event->value);
+		*mOut = event->value;
+	}
+
+private:
+	int* mOut;
+};
+
+class DelayedSumQuery : public AbstractCoroutineQuery<int>
+{
+public:
+	explicit DelayedSumQuery(int threshold) : mThreshold(threshold) {}
+
+protected:
+	Task<int> OnDoAsync() override
+	{
+		co_await NextFrame();
+		co_return SendQuery<SumAboveQuery>(mThreshold);
+	}
+
+private:
+	int mThreshold;
+};
+
+class FailingCoroutineQuery : public AbstractCoroutineQuery<int>
+{
+protected:
+	Task<int> OnDoAsync() override
+	{
+		co_await NextFrame();
+		throw std::runtime_error("coroutine failure");
+	}
+};
+
+class WorkflowCommand : public AbstractCoroutineCommand
+{
+public:
+	explicit WorkflowCommand(std::vector<std::string>* log) : mLog(log) {}
+
+protected:
+	Task<void> OnExecuteAsync() override
+	{
+		mLog->push_back("start");
+		co_await AwaitCommand<AddScoreCommand>(10);
+		mLog->push_back("command " + std::to_string(GetModel<ScoreModel>()->scores.back()));
+		int sum = co_await AwaitQuery<DelayedSumQuery>(5);
+		mLog->push_back("query " + std::to_string(sum));
+		try
+		{
+			co_await AwaitCommand<AsyncThrowingCommand>();
+		}
+		catch (const std::runtime_error&)
+		{
+			mLog->push_back("caught");
+		}
+	}
+
+private:
+	std::vector<std::string>* mLog;
+};
+
+template <typename _Future>
+bool TickUntilReady(Architecture& arch, _Future& future)
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+	while (future.wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+	{
+		if (std::chrono::steady_clock::now() > deadline)
+			return false;
+		arch.Tick();
+	}
+	return true;
+}
+
+TEST(CoroutineTest, CommandResumesOnTickAfterEvent)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	int received = 0;
+	auto future = arch->SendCoroutineCommand<WaitScoreCommand>(&received);
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), 1u);
+
+	arch->SendEvent<ScoreAddedEvent>(7);
+	// ¼ֻǼǻָЭ Tick мִ
+	EXPECT_EQ(received, 0);
+	EXPECT_NE(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+
+	arch->Tick();
+	EXPECT_EQ(received, 7);
+	EXPECT_EQ(future.wait_for(std::chrono::seconds(0)), std::future_status::ready);
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), 0u);
+
+	// ֻȴһ¼
+	arch->SendEvent<ScoreAddedEvent>(8);
+	arch->Tick();
+	EXPECT_EQ(received, 7);
+}
+
+TEST(CoroutineTest, DelayResumesAfterDueTime)
+{
+	class DelayCommand : public AbstractCoroutineCommand
+	{
+	public:
+		explicit DelayCommand(bool* done) : mDone(done) {}
+
+	protected:
+		Task<void> OnExecuteAsync() override
+		{
+			co_await Delay(std::chrono::hours(1));
+			*mDone = true;
+		}
+
+	private:
+		bool* mDone;
+	};
+
+	auto arch = std::make_shared<MyArchitecture>();
+	bool done = false;
+	auto future = arch->SendCoroutineCommand<DelayCommand>(&done);
+	arch->Tick();
+	EXPECT_FALSE(done);
+	// ӳɼܹĶʱʱ
+	EXPECT_EQ(arch->GetTimerService().GetActiveCount(), 1u);
+	arch->GetTimerService().Advance(std::chrono::steady_clock::now() + std::chrono::hours(2));
+	EXPECT_EQ(arch->GetCoroutineScheduler().Tick(), 1u);
+	EXPECT_TRUE(done);
+	EXPECT_NO_THROW(future.get());
+}
+
+TEST(CoroutineTest, AwaitsCommandsAndQueries)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	std::vector<std::string> log;
+	auto future = arch->SendCoroutineCommand<WorkflowCommand>(&log);
+	EXPECT_EQ(log, std::vector<std::string> { "start" });
+
+	ASSERT_TRUE(TickUntilReady(*arch, future));
+	future.get();
+	EXPECT_EQ(log, (std::vector<std::string> { "start", "command 10", "query 10", "caught" }));
+}
+
+TEST(CoroutineTest, SendCoroutineQueryReturnsResult)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	auto sum = arch->SendCoroutineQuery<DelayedSumQuery>(1);
+	auto failing = arch->SendCoroutineQuery<FailingCoroutineQuery>();
+	arch->Tick();
+	EXPECT_EQ(sum.get(), 5);
+	EXPECT_THROW(failing.get(), std::runtime_error);
+
+	CanSendQueryObj obj;
+	obj.mArch = arch;
+	auto viaCapability = obj.SendCoroutineQuery<DelayedSumQuery>(0);
+	arch->Tick();
+	EXPECT_EQ(viaCapability.get(), 6);
+}
+
+TEST(CoroutineTest, ManyWorkflowsShareOneThread)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	constexpr int count = 1000;
+	std::vector<int> received(count, 0);
+	std::vector<std::future<void>> futures;
+	for (int i = 0; i < count; ++i)
+		futures.push_back(arch->SendCoroutineCommand<WaitScoreCommand>(&received[i]));
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), static_cast<size_t>(count));
+
+	arch->SendEvent<ScoreAddedEvent>(3);
+	EXPECT_EQ(arch->GetCoroutineScheduler().Tick(), static_cast<size_t>(count));
+	EXPECT_EQ(std::count(received.begin(), received.end(), 3), count);
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), 0u);
+}
+
+// ڵȴյ¼ӷַʹ̸߳ƵĶбڵȴٺԱ
+class SlowScoreHandler : public ICanHandleEvent
+{
+public:
+	void HandleEvent(std::shared_ptr<IEvent>) override { std::this_thread::sleep_for(std::chrono::microseconds(50)); }
+};
+
+// Эָ̻ȴ֮٣߳ڷַеͬһ¼ܷͷŵĵȴ
+TEST(CoroutineTest, EventAwaiterSurvivesConcurrentSenders)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	SlowScoreHandler slow;
+	arch->RegisterEvent<ScoreAddedEvent>(&slow);
+	std::atomic<bool> stop { false };
+	std::vector<std::thread> senders;
+	for (int t = 0; t < 3; ++t)
+	{
+		senders.emplace_back([&]
+			{
+				while (!stop.load())
+					arch->SendEvent<ScoreAddedEvent>(1);
+			});
+	}
+
+	constexpr int rounds = 200;
+	std::vector<int> received(rounds, 0);
+	for (int i = 0; i < rounds; ++i)
+	{
+		auto future = arch->SendCoroutineCommand<WaitScoreCommand>(&received[i]);
+		while (future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			arch->Tick();
+	}
+	stop = true;
+	for (auto& sender : senders)
+		sender.join();
+
+	EXPECT_EQ(std::count(received.begin(), received.end(), 1), rounds);
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), 0u);
+	arch->UnRegisterEvent<ScoreAddedEvent>(&slow);
+}
+
+TEST(CoroutineTest, DeinitDestroysSuspendedWorkflows)
+{
+	auto arch = std::make_shared<ScoreArchitecture>();
+	arch->InitArchitecture();
+	int received = 0;
+	auto future = arch->SendCoroutineCommand<WaitScoreCommand>(&received);
+	arch->Deinit();
+	EXPECT_EQ(arch->GetCoroutineScheduler().GetActiveCount(), 0u);
+	EXPECT_THROW(future.get(), std::future_error);
+
+	// ȴе¼ע
+	arch->SendEvent<ScoreAddedEvent>(1);
+	arch->Tick();
+	EXPECT_EQ(received, 0);
+	EXPECT_THROW(arch->SendCoroutineCommand(nullptr), std::invalid_argument);
+}
+
+// ¼ַٵЭ̲ᱻǼǵһ Tick
+TEST(CoroutineTest, DeinitRacesEventSenders)
+{
+	for (int round = 0; round < 50; ++round)
+	{
+		auto arch = std::make_shared<ScoreArchitecture>();
+		arch->InitArchitecture();
+		int received = 0;
+		auto future = arch->SendCoroutineCommand<WaitScoreCommand>(&received);
+		std::atomic<bool> stop { false };
+		std::vector<std::thread> senders;
+		for (int t = 0; t < 2; ++t)
+		{
+			senders.emplace_back([&]
+				{
+					while (!stop.load())
+						arch->SendEvent<ScoreAddedEvent>(1);
+				});
+		}
+		arch->Deinit();
+		stop = true;
+		for (auto& sender : senders)
+			sender.join();
+
+		EXPECT_EQ(arch->GetCoroutineScheduler().Tick(), 0u);
+		EXPECT_EQ(received, 0);
+		EXPECT_THROW(future.get(), std::future_error);
+	}
+}
+#endif
+
 // ========== AbstractCommand Ԫ ==========
 class TestArch : public Architecture
 {
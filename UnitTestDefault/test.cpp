@@ -0,0 +1,155 @@
+#include "pch.h"
+// Ĭñ룺κ JFRAMEWORK_ENABLE_* ꣬׷ٵ㡢ͳ
+//  UnitTest µ JFramework.h ͬһжΥ ODR
+#include "../JFramework.h"
+
+using namespace JFramework;
+
+// δ÷ͳʱչΪգ滻ȫ operator new
+JFRAMEWORK_DEFINE_ALLOCATION_HOOKS()
+
+static_assert(!JFRAMEWORK_ENABLE_TRACING && !JFRAMEWORK_ENABLE_ALLOCATION_TRACKING && !JFRAMEWORK_ENABLE_LOCK_PROFILING,
+	"UnitTestDefault must be built without JFRAMEWORK_ENABLE_* definitions");
+
+// ========== Ĭò ==========
+class CountChangedEvent : public IEvent
+{
+public:
+	explicit CountChangedEvent(int value) : value(value) {}
+	int value;
+};
+
+class CounterModel : public AbstractModel
+{
+public:
+	CounterModel() { OwnProperty(count); }
+	BindableProperty<int> count { 0 };
+
+protected:
+	void OnInit() override {}
+	void OnDeinit() override {}
+};
+
+class IncrementCommand : public AbstractUndoableCommand
+{
+protected:
+	void OnExecute() override
+	{
+		auto model = GetModel<CounterModel>();
+		model->count = model->count.GetValue() + 1;
+		SendEvent<CountChangedEvent>(model->count.GetValue());
+	}
+};
+
+class CountQuery : public AbstractQuery<int>
+{
+public:
+	static inline int evaluations = 0;
+
+protected:
+	int OnDo() override
+	{
+		++evaluations;
+		return GetModel<CounterModel>()->count.GetValue();
+	}
+};
+
+class CounterArchitecture : public Architecture
+{
+protected:
+	void Init() override { RegisterModel(std::make_shared<CounterModel>()); }
+};
+
+class CountHandler : public ICanHandleEvent
+{
+public:
+	int last = 0;
+	void HandleEvent(std::shared_ptr<IEvent> event) override
+	{
+		last = std::static_pointer_cast<CountChangedEvent>(event)->value;
+	}
+};
+
+// ִһѯ¼볷ǿڲѡ׷١ͳλ
+static void RunCounterScenario(CounterArchitecture& arch, CountHandler& handler)
+{
+	arch.SendCommand<IncrementCommand>();
+	arch.SendCommand<IncrementCommand>();
+	EXPECT_EQ(handler.last, 2);
+	EXPECT_EQ(arch.SendQuery<CountQuery>(), 2);
+	EXPECT_EQ(arch.SendCachedQuery<CountQuery>(), 2);
+	EXPECT_TRUE(arch.Undo());
+	EXPECT_EQ(arch.SendCachedQuery<CountQuery>(), 1);
+}
+
+TEST(DefaultConfigTest, FrameworkMutexIsStdMutex)
+{
+	static_assert(std::is_base_of_v<std::mutex, FrameworkMutex>, "FrameworkMutex must derive from std::mutex");
+	FrameworkMutex mutex { "DefaultConfigTest" };
+	std::lock_guard<FrameworkMutex> lock(mutex);
+	EXPECT_FALSE(mutex.try_lock());
+}
+
+TEST(DefaultConfigTest, CommandsQueriesEventsAndUndo)
+{
+	auto arch = std::make_shared<CounterArchitecture>();
+	arch->InitArchitecture();
+	CountHandler handler;
+	arch->RegisterEvent<CountChangedEvent>(&handler);
+	CountQuery::evaluations = 0;
+
+	RunCounterScenario(*arch, handler);
+	// һλѯֵʹʧЧֵһ
+	EXPECT_EQ(CountQuery::evaluations, 3);
+	EXPECT_TRUE(arch->Redo());
+	EXPECT_EQ(arch->GetModel<CounterModel>()->count.GetValue(), 2);
+
+	arch->UnRegisterEvent<CountChangedEvent>(&handler);
+	arch->Deinit();
+}
+
+TEST(DefaultConfigTest, TracePointsAreCompiledOut)
+{
+	auto arch = std::make_shared<CounterArchitecture>();
+	arch->InitArchitecture();
+	CountHandler handler;
+	arch->RegisterEvent<CountChangedEvent>(&handler);
+
+	auto& tracer = Tracer::Instance();
+	tracer.Clear();
+	tracer.SetEnabled(true);
+	RunCounterScenario(*arch, handler);
+	tracer.SetEnabled(false);
+	EXPECT_EQ(tracer.GetEventCount(), 0u);
+	arch->UnRegisterEvent<CountChangedEvent>(&handler);
+}
+
+TEST(DefaultConfigTest, AllocationScopesAndHooksAreCompiledOut)
+{
+	auto arch = std::make_shared<CounterArchitecture>();
+	arch->InitArchitecture();
+	CountHandler handler;
+	arch->RegisterEvent<CountChangedEvent>(&handler);
+
+	AllocationTracker::Reset();
+	RunCounterScenario(*arch, handler);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::Command).operations, 0u);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::Query).operations, 0u);
+	EXPECT_EQ(AllocationTracker::GetStats(AllocationOperation::SendEvent).operations, 0u);
+	// ȫ operator new δ滻䲻 AllocationTracker
+	EXPECT_EQ(AllocationTracker::GetThreadAllocationCount(), 0u);
+	arch->UnRegisterEvent<CountChangedEvent>(&handler);
+}
+
+TEST(DefaultConfigTest, LockProfilingIsCompiledOut)
+{
+	LockProfiler::Instance().Reset();
+	auto arch = std::make_shared<CounterArchitecture>();
+	arch->InitArchitecture();
+	CountHandler handler;
+	arch->RegisterEvent<CountChangedEvent>(&handler);
+
+	RunCounterScenario(*arch, handler);
+	EXPECT_TRUE(LockProfiler::Instance().GetStats().empty());
+	arch->UnRegisterEvent<CountChangedEvent>(&handler);
+}